@@ -0,0 +1,102 @@
+/* PlayfairCracker - Crack Playfair Encryptions
+ * Copyright (C) 2018 Yesha Maggi
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+/*
+ * Compares load times of each bundled n-gram file: the previous getline and
+ *  stringstream parser (kept here as a baseline), FrequencyCollector::readNgramCount()
+ *  and the same counts loaded from a binary table with NgramTable.
+ */
+
+#include "FrequencyCollector.hpp"
+#include "NgramTable.hpp"
+#include "PfHelpers.hpp"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
+#define REPEATS 5
+#define TABLE_FILE "bench/table.bin"
+
+namespace {
+	/// Parser that readNgramCount() used before it read the file in place
+	count_t legacyRead(const char* fileName, std::unordered_map<ngram_t, count_t> &freqs) {
+		unsigned long numLines = 0;
+		std::ifstream lineCounter(fileName);
+		std::string buffer;
+		while(!lineCounter.eof()) {
+			std::getline(lineCounter, buffer);
+			++ numLines;
+		}
+		freqs.reserve(numLines);
+
+		count_t totalCount = 0;
+		std::ifstream fileReader(fileName);
+		while(!fileReader.eof()) {
+			std::string line, ngramString, countString;
+			std::getline(fileReader, line);
+			if(line.empty() || line.at(0) == '/') continue;
+			std::stringstream ss(line);
+			ss >> ngramString;
+			ss >> countString;
+			count_t count = std::stoi(countString);
+			totalCount += count;
+			freqs[ngramString] += count;
+		}
+		return totalCount;
+	}
+}
+
+int main() {
+	const char *files[] = {"frequencies/english_monograms.txt", "frequencies/english_bigrams.txt",
+		"frequencies/english_trigrams.txt", "frequencies/english_quadgrams.txt"};
+
+	printf("%-36s %12s %12s %12s\n", "file", "legacy ms", "text ms", "table ms");
+	for(unsigned i = 0; i < sizeof(files) / sizeof(files[0]); i++) {
+		unsigned n = i + 1;
+		count_t checksum = 0;
+
+		PfHelpers::Timer timer;
+		for(unsigned r = 0; r < REPEATS; r++) {
+			std::unordered_map<ngram_t, count_t> freqs;
+			checksum += legacyRead(files[i], freqs);
+		}
+		double legacy = timer.elapsed();
+
+		timer.reset();
+		for(unsigned r = 0; r < REPEATS; r++) {
+			FrequencyCollector freq(n);
+			freq.readNgramCount(files[i]);
+			checksum -= freq.getCount();
+			if(r == 0) freq.writeNgramTable(TABLE_FILE);
+		}
+		double text = timer.elapsed();
+
+		timer.reset();
+		for(unsigned r = 0; r < REPEATS; r++) {
+			NgramTable table(TABLE_FILE);
+			checksum += table.getCount() - table.getCounts()[r % table.size()];
+			checksum += table.getCounts()[r % table.size()];
+			checksum -= table.getCount();
+		}
+		double binary = timer.elapsed();
+
+		printf("%-36s %12.3f %12.3f %12.3f%s\n", files[i], legacy * 1e3 / REPEATS,
+			text * 1e3 / REPEATS, binary * 1e3 / REPEATS, checksum ? "  (mismatch!)" : "");
+	}
+	std::remove(TABLE_FILE);
+	return 0;
+}
@@ -0,0 +1,91 @@
+/* PlayfairCracker - Crack Playfair Encryptions
+ * Copyright (C) 2018 Yesha Maggi
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+/*
+ * Compares decrypting with and without Key::buildDigramTable() for a range of
+ *  cipherText lengths. Each measurement constructs a new Key for every decryption,
+ *  as the genetic algorithm does, so the cost of building the table is included.
+ *  The crossover point is used for DIGRAM_TABLE_MIN. The last column decrypts
+ *  all keys together with a KeyBatch, including the cost of building it.
+ */
+
+#include "Key.hpp"
+#include "KeyBatch.hpp"
+#include "PfHelpers.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+
+#define ALPHABET "ABCDEFGHIKLMNOPQRSTUVWXYZ"
+#define NUM_KEYS 2000
+
+int main() {
+	std::mt19937 rng(1);
+	vector<string> keys;
+	for(unsigned i = 0; i < NUM_KEYS; i++) {
+		string key = ALPHABET;
+		std::shuffle(key.begin(), key.end(), rng);
+		keys.push_back(key);
+	}
+	std::uniform_int_distribution<int> letter(0, 24);
+
+	printf("%8s %14s %14s %14s\n", "length", "direct us/key", "table us/key",
+		"batch us/key");
+	unsigned lengths[] = {100, 250, 500, 750, 1000, 1250, 1500, 2000, 4000, 8000};
+	for(unsigned length : lengths) {
+		vector<char> cipherText(length);
+		for(unsigned i = 0; i < length; i++) {
+			cipherText[i] = ALPHABET[letter(rng)];
+		}
+		vector<char> plainText;
+		unsigned long checksum = 0;
+
+		PfHelpers::Timer timer;
+		for(unsigned i = 0; i < NUM_KEYS; i++) {
+			Key key(keys[i]);
+			key.decrypt(cipherText, plainText);
+			checksum += plainText[i % length];
+		}
+		double direct = timer.elapsed();
+
+		timer.reset();
+		for(unsigned i = 0; i < NUM_KEYS; i++) {
+			Key key(keys[i]);
+			key.buildDigramTable();
+			key.decrypt(cipherText, plainText);
+			checksum -= plainText[i % length];
+		}
+		double table = timer.elapsed();
+
+		timer.reset();
+		vector<vector<char>> plainTexts;
+		KeyBatch batch(keys);
+		batch.decrypt(cipherText, plainTexts);
+		for(unsigned i = 0; i < NUM_KEYS; i++) {
+			checksum += plainTexts[i][i % length];
+		}
+		double batched = timer.elapsed();
+
+		timer.reset();
+		for(unsigned i = 0; i < NUM_KEYS; i++) {
+			Key key(keys[i]);
+			key.decrypt(cipherText, plainText);
+			checksum -= plainText[i % length];
+		}
+
+		printf("%8u %14.3f %14.3f %14.3f%s\n", length, direct * 1e6 / NUM_KEYS,
+			table * 1e6 / NUM_KEYS, batched * 1e6 / NUM_KEYS, checksum ? "  (mismatch!)" : "");
+	}
+	return 0;
+}
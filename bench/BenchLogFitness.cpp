@@ -0,0 +1,106 @@
+/* PlayfairCracker - Crack Playfair Encryptions
+ * Copyright (C) 2018 Yesha Maggi
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+/*
+ * Compares the scalar and AVX2 kernels specialized on n, as picked by
+ *  LogFitness, against the rolling index loop with n known only at runtime that
+ *  they replaced. Each text is a random decryption-sized run of uppercase letters.
+ */
+
+#include "LogFitness.hpp"
+#include "FrequencyCollector.hpp"
+#include "NgramKernel.hpp"
+#include "PfHelpers.hpp"
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+#define NUM_TEXTS 200
+#define REPEATS 50
+
+namespace {
+	/// Scoring loop that LogFitness::score() used before NgramKernel
+	score_t rollingScore(const vector<score_t> &table, const vector<char> &text, unsigned n) {
+		const unsigned long high = table.size() / 26;
+		unsigned long index = FrequencyCollector::ngramIndex(text.data(), n - 1);
+		score_t score = 0;
+		for(unsigned long pos = n - 1; pos < text.size(); pos++) {
+			index = (index % high) * 26 + (text[pos] - 'A');
+			score += table[index];
+		}
+		return score;
+	}
+}
+
+int main() {
+	const char *files[] = {"frequencies/english_bigrams.txt", "frequencies/english_trigrams.txt",
+		"frequencies/english_quadgrams.txt"};
+	std::mt19937 rng(1);
+	std::uniform_int_distribution<int> letter(0, 25);
+	vector<vector<char>> texts(NUM_TEXTS, vector<char>(1000));
+	for(auto it = texts.begin(); it != texts.end(); ++it) {
+		for(unsigned i = 0; i < it->size(); i++) {
+			(*it)[i] = 'A' + letter(rng);
+		}
+	}
+
+	printf("%4s %16s %16s %16s\n", "n", "rolling ns/text", "scalar ns/text",
+		NgramKernel::hasSimd() ? "avx2 ns/text" : "(no avx2)");
+	for(unsigned n = 2; n <= 4; n++) {
+		FrequencyCollector standardFreq(n);
+		standardFreq.readNgramCount(files[n - 2]);
+		LogFitness fit(standardFreq);
+		vector<score_t> table = standardFreq.frequencyTable();
+		for(auto it = table.begin(); it != table.end(); ++it) {
+			*it = *it > 0 ? std::log10(*it) : fit.getFloor();
+		}
+
+		score_t checksum = 0;
+		PfHelpers::Timer timer;
+		for(unsigned r = 0; r < REPEATS; r++) {
+			for(auto it = texts.begin(); it != texts.end(); ++it) {
+				checksum += rollingScore(table, *it, n);
+			}
+		}
+		double rolling = timer.elapsed();
+
+		NgramKernel::SumKernel scalarSum = NgramKernel::sumKernel(n, false);
+		score_t scalarTotal = 0;
+		timer.reset();
+		for(unsigned r = 0; r < REPEATS; r++) {
+			for(auto it = texts.begin(); it != texts.end(); ++it) {
+				scalarTotal += scalarSum(table.data(), it->data(), it->size() - n + 1);
+			}
+		}
+		double scalar = timer.elapsed();
+		checksum -= scalarTotal;
+
+		//	LogFitness picks the AVX2 kernel when the CPU has it
+		score_t simdTotal = 0;
+		timer.reset();
+		for(unsigned r = 0; r < REPEATS; r++) {
+			for(auto it = texts.begin(); it != texts.end(); ++it) {
+				simdTotal += fit.score(*it);
+			}
+		}
+		double simd = timer.elapsed();
+		if(simdTotal != scalarTotal) checksum = 1;
+
+		printf("%4u %16.1f %16.1f %16.1f%s\n", n, rolling * 1e9 / (REPEATS * NUM_TEXTS),
+			scalar * 1e9 / (REPEATS * NUM_TEXTS), simd * 1e9 / (REPEATS * NUM_TEXTS),
+			std::abs(checksum) > 1e-6 ? "  (mismatch!)" : "");
+	}
+	return 0;
+}
@@ -27,7 +27,7 @@ int main() {
 		return -1;
 	}
 	
-	GenParams genParams { 12, 4, 0, 0.2, 2, 1 };
+	GenParams genParams { 12, 4, SWAP, 2, 1, TOURNAMENT, 3, 2 };
 
 	std::string seed = "Apple";
 	pop_t population;
@@ -15,9 +15,26 @@
 #ifndef ENGLISHFITNESS_HPP
 #define ENGLISHFITNESS_HPP
 
+#include "Fitness.hpp"
 #include "FrequencyCollector.hpp"
+#include "NgramTable.hpp"
+#include "NgramKernel.hpp"
+#include <vector>
 
-typedef double score_t;
+/**
+ * How EnglishFitness::fitness() visits the n-grams. Both modes produce the same score.
+ */
+enum FitnessMode {
+	/**
+	 * Every one of the 26^n n-grams is compared.
+	 */
+	DENSE,
+	/**
+	 * Only the n-grams present in the test frequencies are visited. The sum over
+	 * 	the standard frequencies is precomputed during construction.
+	 */
+	SPARSE
+};
 
 /**
  * @brief Rate how likely a text is English
@@ -25,13 +42,23 @@ typedef double score_t;
  * Rate the fitness of how likely a text is English, or given frequencies.
  * 
  * @param standardFreq The standard n-gram frequencies the fitnessfunction is compared against
+ * @param mode         See FitnessMode
  */
-class EnglishFitness {
+class EnglishFitness : public Fitness {
 public:
 	/**
 	 * @param standardFreq  The standard frequencies the fitnessfunction is compared against
+	 * @param mode          See FitnessMode
+	 * 
+	 * @throw InvalidParameters     If standardFreq.getN() > MAX_TABLE_N
+	 */
+	EnglishFitness(const FrequencyCollector &standardFreq, FitnessMode mode = DENSE);
+
+	/**
+	 * @param standardTable Binary table of the standard n-gram counts
+	 * @param mode          See FitnessMode
 	 */
-	EnglishFitness(const FrequencyCollector &standardFreq);
+	EnglishFitness(const NgramTable &standardTable, FitnessMode mode = DENSE);
 	~EnglishFitness();
 
 	/**
@@ -43,6 +70,18 @@ public:
 	 * @return score_t
 	 */
 	score_t fitness(const FrequencyCollector &testFreq) const;
+	/**
+	 * @brief Collect fitness score for a text
+	 * 
+	 * Returns the same score as fitness() of the n-gram frequencies of text. The
+	 *  n-grams are indexed straight from text, without a FrequencyCollector.
+	 * 
+	 * @throw Exception     If text is shorter than n
+	 * 
+	 * @param text  Uppercase letters A to Z only
+	 * @return score_t
+	 */
+	score_t score(const std::vector<char> &text) const;
 	/**
 	 * @brief Return n-gram size associated with this object
 	 * 
@@ -51,6 +90,12 @@ public:
 	 * @return unsigned int
 	 */
 	unsigned getN() const;
+	/**
+	 * @brief Return the FitnessMode associated with this object
+	 * 
+	 * @return FitnessMode
+	 */
+	FitnessMode getMode() const;
 	/**
 	 * @brief Return the maximum fitness score possible
 	 * 
@@ -65,8 +110,16 @@ public:
 	score_t maxFitness(const FrequencyCollector &testFreq) const;
 
 private:
-	FrequencyCollector sFreq;
+	/// Standard frequencies as a dense table, see FrequencyCollector::frequencyTable()
+	std::vector<double> sTable;
+	/// Total count of the standard n-grams
+	count_t sCount;
+	/// sum{S^2} over the standard table, used by SPARSE
+	double sSquares;
 	unsigned n;
+	FitnessMode mode;
+	/// Window indexing specialized on n, chosen on construction
+	NgramKernel::IndexKernel indexWindows;
 
 };
 
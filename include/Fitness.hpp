@@ -0,0 +1,73 @@
+/* PlayfairCracker - Crack Playfair Encryptions
+ * Copyright (C) 2018 Yesha Maggi
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef FITNESS_HPP
+#define FITNESS_HPP
+
+#include <cstddef>
+#include <vector>
+
+typedef double score_t;
+
+/**
+ * @brief Interface for rating how likely a decrypted text is English
+ * 
+ * A fitness function rates a text given as uppercase letters, as returned by
+ * 	Key::decrypt(). Higher scores are better. See EnglishFitness and LogFitness.
+ * 
+ * PlayfairGenetic::fitScores() calls score() from several threads at once, so it
+ * 	must not modify the object.
+ */
+class Fitness {
+public:
+	virtual ~Fitness() {}
+
+	/**
+	 * @brief Collect fitness score for a text
+	 * 
+	 * Collect fitness score for a text.
+	 * 
+	 * @param text  Uppercase letters A to Z only
+	 * @return score_t
+	 */
+	virtual score_t score(const std::vector<char> &text) const = 0;
+
+	/**
+	 * @brief Collect fitness score for a text after some of its digrams changed
+	 * 
+	 * Returns the same score as score(newText). This default just calls it.
+	 * 	Fitness functions that sum independent n-gram windows override this to only
+	 * 	rescore the windows touching a changed digram.
+	 * 
+	 * @param oldText   The text before the change
+	 * @param oldScore  score(oldText)
+	 * @param newText   The text after the change, same length as oldText
+	 * @param changed   Index of the first letter of each changed digram, in
+	 * 					ascending order. See Key::decryptSwap()
+	 * @return score_t
+	 */
+	virtual score_t rescore(const std::vector<char> &oldText, score_t oldScore,
+			const std::vector<char> &newText, const std::vector<std::size_t> &changed) const {
+		return score(newText);
+	}
+
+	/**
+	 * @brief Return n-gram size associated with this object
+	 * 
+	 * @return unsigned int
+	 */
+	virtual unsigned getN() const = 0;
+};
+
+#endif // FITNESS_HPP
@@ -15,11 +15,31 @@
 #ifndef FREQUENCYCOLLECTOR_HPP
 #define FREQUENCYCOLLECTOR_HPP
 
+#include <cstddef>
+#include <string>
 #include <unordered_map>
+#include <vector>
+
+/// Largest n that frequencyTable() will build a dense table for (26^5 entries)
+#define MAX_TABLE_N 5
+
+/**
+ * collectNGrams(const char*, std::size_t) only counts into a dense table when the
+ *  text has at least 1/DENSE_COLLECT_RATIO as many n-grams as the table has entries
+ */
+#define DENSE_COLLECT_RATIO 8
+
+/// Bytes of text read at a time by collectNGramsFile()
+#define COLLECT_CHUNK_SIZE (1 << 20)
+
+/// Most bytes the per-thread tables of collectNGramsFiles() may take together
+#define MAX_COLLECT_TABLE_BYTES (512ul << 20)
 
 typedef unsigned long long count_t;
 typedef std::string ngram_t;
 
+class NgramTable;
+
 /**
  * @brief Collect and manage frequencies of English n-grams
  * 
@@ -63,7 +83,7 @@ public:
      * ER 7713
      * @endcode
      * 
-     * Explanation will be printed to stderr if false.
+     * Every line in error is reported to stderr, with its line number, if false.
      * 
      * @param fileName  The file to be checked
      * @return  bool
@@ -79,8 +99,10 @@ public:
      * @note Any n-grams collected are added to the current counts. Call clear() prior to
      *          this function if necessary.
      * 
+     * The file is memory mapped and parsed in a single pass.
+     * 
      * @throw std::ios_base::failure    fileName cannot be opened
-     * @throw Exception                 n-gram length contradiction
+     * @throw Exception                 n-gram length contradiction, or missing count
      * 
      * @b Basic @b guarantee: Will not throw exceptions if validNgramFile(fileName)
      * returns true.
@@ -102,6 +124,35 @@ public:
      */
     int writeNGramCount(const char* fileName);
 
+    /**
+     * @brief Read a binary n-gram table file
+     * 
+     * Read counts from a binary table written by writeNgramTable(). See NgramTable
+     *  for the format. Counts are added to the current counts, as in readNgramCount().
+     * 
+     * @throw std::ios_base::failure    fileName cannot be opened
+     * @throw Exception                 Not a table file, or n-gram length contradiction
+     * 
+     * @param fileName  The file to be read
+     * @return  0 on completion
+     */
+    int readNgramTable(const char* fileName);
+
+    /**
+     * @brief Writes n-gram counts to a binary table file
+     * 
+     * Write current n-gram counts to fileName as a dense binary table, which
+     *  NgramTable can load without parsing. N-grams that are not all uppercase
+     *  letters are left out.
+     * 
+     * @throw std::ios_base::failure    fileName cannot be opened for write
+     * @throw InvalidParameters         If n > MAX_TABLE_N
+     * 
+     * @param fileName  The file to be written
+     * @return  0 on completion
+     */
+    int writeNgramTable(const char* fileName) const;
+
     /**
      * @brief Collects n-gram frequencies and writes to file
      * 
@@ -124,15 +175,42 @@ public:
      * frequencies are collected. All letters are read as uppercase. See collectNGrams()
      * for example.
      * 
+     * The file is streamed in chunks of chunkSize bytes, so memory use is bounded by
+     *  the number of distinct n-grams rather than the size of the file. N-grams that
+     *  span two chunks are counted.
+     * 
      * @note Any n-grams collected are added to the current counts. Call clear() prior to
      *          this function if necessary.
      * 
      * @throw std::ios_base::failure    fileName cannot be opened
+     * @throw InvalidParameters         If chunkSize == 0
      * 
      * @param fileName  The file to be read
+     * @param chunkSize Bytes read from the file at a time
+     * @return  0 on completion
+     */
+    int collectNGramsFile(const char* fileName, std::size_t chunkSize = COLLECT_CHUNK_SIZE);
+
+    /**
+     * @brief Parses files to collect n-gram frequencies on several threads
+     * 
+     * Same result as calling collectNGramsFile() on each file in turn. Each file is
+     *  memory mapped and split into one slice per thread. Every thread counts the
+     *  n-grams ending in its slice into its own dense table, priming its window with
+     *  the letters just before the slice, and the tables are merged at the end.
+     * 
+     * @note Each thread holds a table of tableSize(n) counts (26^4 * 8 bytes = 3.6 MB
+     *          for quadgrams, 95 MB for n = 5). Fewer threads are used if the tables
+     *          would take more than MAX_COLLECT_TABLE_BYTES. With one thread, or
+     *          n > MAX_TABLE_N, this simply calls collectNGramsFile().
+     * 
+     * @throw std::ios_base::failure    A file cannot be opened
+     * 
+     * @param fileNames The files to be read
+     * @param threads   Number of threads to count on
      * @return  0 on completion
      */
-    int collectNGramsFile(const char* fileName);
+    int collectNGramsFiles(const std::vector<const char*> &fileNames, unsigned threads);
 
     /**
      * @brief Parse stringstream to collect n-gram frequencies
@@ -171,10 +249,57 @@ public:
      */
     int collectNGrams(std::stringstream &buffer);
 
+    /**
+     * @brief Collect n-gram frequencies of uppercase text in memory
+     * 
+     * Same counts as collectNGrams(std::stringstream&) on the same text, for text
+     *  that holds nothing but the letters A to Z, such as a decrypted plainText.
+     *  No stream or locale is involved: the windows are indexed with
+     *  NgramKernel::indexKernel(). When the text is long enough to fill a fair part
+     *  of a table of tableSize(n) counts (see DENSE_COLLECT_RATIO), they are counted
+     *  there. Otherwise, and for any n > MAX_TABLE_N, the indices are sorted and
+     *  each distinct n-gram is added once, so short text costs no more than its
+     *  length.
+     * 
+     * @throw Exception     If text holds anything other than A to Z
+     * 
+     * @param text  Text to be read
+     * @param size  Number of letters in text
+     * @return  0 on completion
+     */
+    int collectNGrams(const char *text, std::size_t size);
+
+    /**
+     * @brief Merge counts from another collector
+     * 
+     * Adds every count of other to this object, as if the text other was collected
+     *  from had been collected here as well.
+     * 
+     * @throw Exception     If other.getN() != getN()
+     * 
+     * @param other The counts to add
+     * @return  Reference to this object
+     */
+    FrequencyCollector& operator+=(const FrequencyCollector &other);
+
+    /**
+     * @brief Merge counts from a binary n-gram table
+     * 
+     * Adds the dense counts of table to this object, without looking up n-grams
+     *  that have no count.
+     * 
+     * @throw Exception     If table.getN() != getN()
+     * 
+     * @param table The counts to add
+     * @return  Reference to this object
+     */
+    FrequencyCollector& operator+=(const NgramTable &table);
+
     /**
      * @brief Print n-gram counts
      * 
-     * Writes n-gram counts to buffer. Pass std::cout to print to screen.
+     * Writes n-gram counts to buffer, most common first and ties in alphabetical
+     *  order. Pass std::cout to print to screen.
      * 
      * @param buffer  Output stream to be written to
      * @return  0 on completion
@@ -216,6 +341,63 @@ public:
      */
     double frequency(ngram_t ngram) const;
 
+    /**
+     * @brief Returns the collected n-gram counts
+     * 
+     * Returns the counts of each n-gram collected so far. Only n-grams that were
+     *  collected are present. Divide a count by getCount() to get the frequency.
+     * 
+     * @return const reference to the map of counts
+     */
+    const std::unordered_map<ngram_t, count_t> &getCounts() const;
+
+    /**
+     * @brief Get frequencies of all n-grams as a dense table
+     * 
+     * Returns the frequency of every uppercase n-gram in a contiguous table of
+     *  tableSize(n) entries, indexed by ngramIndex(). N-grams that were never
+     *  collected have frequency 0.0. Intended to be built once and reused, so that
+     *  lookups are array indexing rather than hashing strings.
+     * 
+     * @throw InvalidParameters     If n > MAX_TABLE_N
+     * 
+     * @return vector<double>
+     */
+    std::vector<double> frequencyTable() const;
+
+    /**
+     * @brief Returns the number of entries in a dense n-gram table
+     * 
+     * Returns 26^n, the number of uppercase n-grams of length n.
+     * 
+     * @param n     Size of n-gram
+     * @return unsigned long
+     */
+    static unsigned long tableSize(unsigned n);
+
+    /**
+     * @brief Returns the index of an n-gram in a dense table
+     * 
+     * Each uppercase n-gram is read as a base-26 number, the first letter being the
+     *  most significant digit. (e.g. AA = 0, AB = 1, BA = 26)
+     * 
+     * @param ngram Pointer to the first of n uppercase letters
+     * @param n     Size of n-gram
+     * @return unsigned long in range [0, tableSize(n))
+     */
+    static unsigned long ngramIndex(const char *ngram, unsigned n);
+
+    /**
+     * @brief Checks if an n-gram has a place in a dense table
+     * 
+     * Returns true if all n letters are uppercase A to Z.
+     * 
+     * @param ngram Pointer to the first of n letters
+     * @param n     Size of n-gram
+     * @return bool
+     */
+    static bool tableNgram(const char *ngram, unsigned n);
+
     /**
      * @brief Checks if object has collected frequencies
      * 
@@ -250,16 +432,28 @@ private:
     std::unordered_map<ngram_t, count_t> freqs;
 
     /**
-     * @brief Returns the number of lines in a file
+     * @brief Collects n-grams from one chunk of text
      * 
-     * Returns the number of lines in a file.
+     * Collects n-grams from size bytes of text. window holds the last n letters read
+     *  and filled how many of them are valid, carried from one chunk to the next.
+     *  Start with filled = 0 and window of size n.
      * 
-     * @throw std::ios_base::failure    fileName cannot be opened
+     * @param text      Chunk of text
+     * @param size      Number of bytes in text
+     * @param window    Last letters read, carried between chunks
+     * @param filled    Number of letters in window
+     */
+    void collectChunk(const char *text, std::size_t size, ngram_t &window, unsigned &filled);
+
+    /**
+     * @brief Adds a dense table of counts
      * 
-     * @param fileName  The file to be read
-     * @return unsigned long
+     * Adds tableSize(n) counts, indexed by ngramIndex(), and count to totalCount.
+     * 
+     * @param counts    Dense table of counts
+     * @param count     Total of counts
      */
-    unsigned long numFileLines(const char* fileName);
+    void addTable(const count_t *counts, count_t count);
 };
 
 #endif // FREQUENCYCOLLECTOR_HPP
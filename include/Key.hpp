@@ -15,7 +15,8 @@
 #ifndef KEY_HPP
 #define KEY_HPP
 
-#include <unordered_map>
+#include <string>
+#include <utility>
 #include <vector>
 
 #define LFILL 'X'
@@ -23,6 +24,15 @@
 #define LOMIT 'J'
 #define LREPL 'I'
 
+/**
+ * Length of cipherText from which building a digram table before decrypting is
+ *  faster than decrypting each digram directly. See bench/BenchKey.cpp.
+ */
+#define DIGRAM_TABLE_MIN 1000
+
+/// A pair of letters, as en/decrypted together by the Playfair cipher
+typedef std::pair<char, char> digram_t;
+
 /**
  * @brief %Key to encrypt & decrypt messages with the Playfair cipher
  * 
@@ -71,11 +81,23 @@ public:
      * @details     Call sanitizeText() on plainText before using this function to ensure no
      *                  errors occur.
      * 
-     * @param plainText     Must only contain the 25 valid uppercase characters. There will
-     *                          be errors otherwise. (Likely out_of_range exception).
+     * @param plainText     Must only contain the 25 valid uppercase characters. The result
+     *                          is undefined otherwise.
      * @return  Encrypted cipherText
      */
-    std::vector<char> encrypt(const std::vector<char> &plainText);
+    std::vector<char> encrypt(const std::vector<char> &plainText) const;
+
+    /**
+     * @brief       Encrypts plainText with key into a given buffer
+     * @details     Same as encrypt(plainText), but cipherText is cleared and written to
+     *                  instead of returning a new vector. Reusing the same cipherText
+     *                  between calls avoids allocating once its capacity is large enough.
+     * 
+     * @param plainText     Must only contain the 25 valid uppercase characters.
+     * @param cipherText    Buffer the encrypted text is written to
+     * @return  Reference to cipherText
+     */
+    std::vector<char> &encrypt(const std::vector<char> &plainText, std::vector<char> &cipherText) const;
 
     /**
      * @brief       Decrypts cipherText with key
@@ -83,11 +105,104 @@ public:
      *                  errors occur. Letters added during encryption, due to double letters
      *                  or odd length text, are still included in decrypted text.
      * 
-     * @param cipherText    Must only contain the 25 valid uppercase characters. There will
-     *                          be errors otherwise. (Likely out_of_range exception).
+     * @param cipherText    Must only contain the 25 valid uppercase characters. The result
+     *                          is undefined otherwise.
      * @return Decrypted plainText
      */
-    std::vector<char> decrypt(const std::vector<char> &cipherText);
+    std::vector<char> decrypt(const std::vector<char> &cipherText) const;
+
+    /**
+     * @brief       Decrypts cipherText with key into a given buffer
+     * @details     Same as decrypt(cipherText), but plainText is resized and written to
+     *                  instead of returning a new vector. Reusing the same plainText
+     *                  between calls avoids allocating once its capacity is large enough.
+     * 
+     * @param cipherText    Must only contain the 25 valid uppercase characters.
+     * @param plainText     Buffer the decrypted text is written to
+     * @return  Reference to plainText
+     */
+    std::vector<char> &decrypt(const std::vector<char> &cipherText, std::vector<char> &plainText) const;
+
+    /**
+     * @brief       Swaps two letters in the square
+     * @details     Swaps the places of letters a and b in the square. The digram table
+     *                  is dropped, as it no longer matches the square. Swapping the same
+     *                  letters again restores the key.
+     * 
+     * @param a     A letter in the square
+     * @param b     A letter in the square
+     * @return  0 on completion
+     */
+    int swapLetters(char a, char b);
+
+    /**
+     * @brief       Swaps two letters in the square and updates a decryption
+     * @details     plainText must hold decrypt(cipherText) for this key before the swap.
+     *                  Letters a and b are swapped with swapLetters(), then only the
+     *                  digrams with a or b in the cipherText digram are decrypted
+     *                  again. Every other digram decrypts from the same places as
+     *                  before, so its new plainText is the old one with a and b
+     *                  exchanged.
+     * 
+     * @param cipherText    The cipherText that plainText was decrypted from
+     * @param plainText     Decryption of cipherText before the swap. Updated in place.
+     * @param a             A letter in the square
+     * @param b             A letter in the square
+     * @param changed       Cleared, then set to the index in plainText of the first
+     *                          letter of every digram that changed, in ascending order
+     * @return  Reference to changed
+     */
+    std::vector<std::size_t> &decryptSwap(const std::vector<char> &cipherText,
+            std::vector<char> &plainText, char a, char b, std::vector<std::size_t> &changed);
+
+    /**
+     * @brief       Returns the 25 letters of the square, row by row
+     * 
+     * @return  The square as a string
+     */
+    std::string getSquare() const;
+
+    /**
+     * @brief       Returns the square in the same form for all its rotations
+     * @details     Shifting the rows or the columns of a square cyclically does not
+     *                  change how it decrypts, so 25 squares decrypt alike. They are
+     *                  all brought to the one that has the smallest letter at row 0
+     *                  and column 0.
+     * 
+     * @param square    The 25 letters of a square, row by row, as from getSquare()
+     * @return  The rotated square
+     * @throw std::invalid_argument if square does not have 25 letters
+     */
+    static std::string canonicalSquare(const std::string &square);
+
+    /**
+     * @brief       Returns the same string for all keys that decrypt alike
+     * @details     Keys that are full squares, as in the genetic algorithm, are
+     *                  taken as they are. Others are first turned into a square with
+     *                  the default letters, as Key(key) would.
+     * 
+     * @param key       A keyword or the 25 letters of a square
+     * @return  canonicalSquare() of the square of key
+     */
+    static std::string canonicalKey(const std::string &key);
+
+    /**
+     * @brief       Precompute the decryption of every digram
+     * @details     Decrypts all 25 x 25 digrams of the square once and stores them in a
+     *                  table. Afterwards decrypt() looks each digram up instead of
+     *                  working out its rows and columns. This only pays off when
+     *                  decrypting long texts with this key, see DIGRAM_TABLE_MIN.
+     * 
+     * @return  0 on completion
+     */
+    int buildDigramTable();
+
+    /**
+     * @brief       Returns true if buildDigramTable() has been called
+     * 
+     * @return  bool
+     */
+    bool hasDigramTable() const;
 
     /**
      * @brief   Prepare text for encrypt() and decrypt()
@@ -107,13 +222,22 @@ public:
 private:
     ///  The keyword to the cipher
     std::string keyword;
-    ///  This is the square that the en/decryption is done with
-    char key[5][5];
-    /**  
-    *  @brief A letter's place in the square is held as a number 0-24.
-    *    As if writing the numbers sequentially left to right, top down.
+    /**
+    *  @brief This is the square that the en/decryption is done with
+    *    Held row by row, so the letter at row r and column c is key[5 * r + c].
+    */
+    char key[25];
+    /**
+    *  @brief Row and column of each letter in the square, indexed by letter - 'A'.
+    *    Both are -1 for the omitted letter.
+    */
+    signed char letterRow[26];
+    signed char letterColumn[26];
+    /**
+    *  @brief Decryption of every digram, see buildDigramTable(). Empty unless built.
+    *    The digram of the letters at places a and b is digramTable[25 * a + b].
     */
-    std::unordered_map<char, int> letterPlace;
+    std::vector<digram_t> digramTable;
 
     ///  The letter that will be inserted between double letters
     char bufferDouble = LFILL;
@@ -134,20 +258,21 @@ private:
     /**
      * @brief   Encrypts digram 
      * 
-     * @return  Encrypted digram as char[2]
+     * @return  Encrypted digram
      */
-    char* encryptDigram(char a, char b);
+    digram_t encryptDigram(char a, char b) const;
 
     /**
      * @brief   Decrypts digram 
      * 
-     * @return  Decrypted digram as char[2]
+     * @return  Decrypted digram
      */
-    char* decryptDigram(char a, char b);  
+    digram_t decryptDigram(char a, char b) const;
 
-    //  Helper functions to determing letter positioning from the int stored in letterPlace
-    int getRow(int place);
-    int getColumn(int place);
+    //  Helper functions to determing letter positioning from its place 0-24 in the square
+    int getPlace(char letter) const;
+    int getRow(int place) const;
+    int getColumn(int place) const;
 };
 
 #endif // KEY_HPP
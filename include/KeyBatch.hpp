@@ -0,0 +1,86 @@
+/* PlayfairCracker - Crack Playfair Encryptions
+ * Copyright (C) 2018 Yesha Maggi
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#ifndef KEYBATCH_HPP
+#define KEYBATCH_HPP
+
+#include "Key.hpp"
+#include <string>
+#include <vector>
+
+/**
+ * Number of keys decrypted together in each pass over the cipherText by
+ *  KeyBatch::decrypt(). See bench/BenchKey.cpp.
+ */
+#define KEY_BATCH_BLOCK 64
+
+/**
+ * @brief Many Playfair keys decrypting the same cipherText together
+ * 
+ * Holds the squares of a batch of keys as a structure of arrays: the row of a
+ * letter is kept for all keys next to each other, as are the column of a letter
+ * and the letter at each place of the square. decrypt() walks the cipherText
+ * once, and decrypts each digram with every key before moving on to the next, so
+ * the cipherText and the lookups for one digram stay in cache across the batch.
+ * 
+ * Each key decrypts exactly as Key::decrypt() would with the same square.
+ * 
+ * @attention Call Key::sanitizeText() on cipherText before decrypt().
+ */
+class KeyBatch {
+public:
+    /**
+     * @param keys          Keywords of the keys in the batch, as given to Key
+     * @param extraFill     The letter added to the end of an odd length cipherText
+     */
+    KeyBatch(const std::vector<std::string> &keys, char extraFill = LEXTR);
+    ~KeyBatch();
+
+    /**
+     * @brief       Decrypt cipherText with every key in the batch
+     * 
+     * @param cipherText    Sanitized cipherText
+     * @param plainTexts    Resized to size(). plainTexts[k] is set to the decryption
+     *                          with keys[k]. Existing buffers are reused.
+     * @return  Reference to plainTexts
+     */
+    std::vector<std::vector<char>> &decrypt(const std::vector<char> &cipherText,
+            std::vector<std::vector<char>> &plainTexts) const;
+
+    /**
+     * @brief       Returns the number of keys in the batch
+     * 
+     * @return  Number of keys
+     */
+    std::size_t size() const;
+private:
+    ///  Number of keys in the batch
+    std::size_t count;
+    /**
+    *  @brief Row and column of each letter in every square, indexed by
+    *    (letter - 'A') * count + k for key k. Both are -1 for the omitted letter.
+    */
+    std::vector<signed char> letterRow;
+    std::vector<signed char> letterColumn;
+    /**
+    *  @brief Letter at each place of every square, indexed by place * count + k,
+    *    where the place of row r and column c is 5 * r + c.
+    */
+    std::vector<char> square;
+    ///  The letter that will be added at the end of an odd length cipherText
+    char bufferExtra;
+};
+
+#endif
@@ -0,0 +1,103 @@
+/* PlayfairCracker - Crack Playfair Encryptions
+ * Copyright (C) 2018 Yesha Maggi
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef LOGFITNESS_HPP
+#define LOGFITNESS_HPP
+
+#include "Fitness.hpp"
+#include "FrequencyCollector.hpp"
+#include "NgramTable.hpp"
+#include "NgramKernel.hpp"
+#include <vector>
+
+/**
+ * @brief Rate how likely a text is English with n-gram log probabilities
+ * 
+ * The score of a text is the sum of log10 of the probability of each of its n-grams,
+ * 	as given by the standard frequencies. N-grams never seen in the standard get a
+ * 	floor probability of 0.01 / total count. Scores are negative, and closer to 0 is
+ * 	better.
+ * 
+ * The log probability of every n-gram is computed once during construction, so
+ * 	scoring a text is a single pass over it with no FrequencyCollector.
+ * 
+ * @param standardFreq The standard n-gram frequencies the fitness function uses
+ */
+class LogFitness : public Fitness {
+public:
+	/**
+	 * @param standardFreq  The standard n-gram frequencies the fitness function uses
+	 * 
+	 * @throw InvalidParameters     If standardFreq.getN() > MAX_TABLE_N
+	 * @throw Exception             If standardFreq is empty
+	 */
+	LogFitness(const FrequencyCollector &standardFreq);
+
+	/**
+	 * @param standardTable Binary table of the standard n-gram counts
+	 * 
+	 * @throw Exception             If standardTable is empty
+	 */
+	LogFitness(const NgramTable &standardTable);
+	~LogFitness();
+
+	/**
+	 * @brief Collect fitness score for a text
+	 * 
+	 * Sums the log probability of every n-gram in text.
+	 * 
+	 * @throw Exception     If text is shorter than n
+	 * 
+	 * @param text  Uppercase letters A to Z only
+	 * @return score_t
+	 */
+	score_t score(const std::vector<char> &text) const;
+	/**
+	 * @brief Collect fitness score for a text after some of its digrams changed
+	 * 
+	 * Only the n-grams overlapping a changed digram are looked up, in both texts,
+	 * 	and the difference is added to oldScore. See Fitness::rescore().
+	 * 
+	 * @throw Exception     If newText is shorter than n
+	 * 
+	 * @return score_t
+	 */
+	score_t rescore(const std::vector<char> &oldText, score_t oldScore,
+			const std::vector<char> &newText, const std::vector<std::size_t> &changed) const;
+	/**
+	 * @brief Return n-gram size associated with this object
+	 * 
+	 * @return unsigned int
+	 */
+	unsigned getN() const;
+	/**
+	 * @brief Return the log probability given to unseen n-grams
+	 * 
+	 * @return score_t
+	 */
+	score_t getFloor() const;
+
+private:
+	/// Turns a table of frequencies into logTable, counts of zero scoring floor
+	void buildTable(std::vector<double> frequencies, count_t count);
+
+	/// log10 probability of each n-gram, indexed by FrequencyCollector::ngramIndex()
+	std::vector<score_t> logTable;
+	score_t floor;
+	unsigned n;
+	/// Window summing specialized on n, chosen on construction
+	NgramKernel::SumKernel sumWindows;
+};
+
+#endif // LOGFITNESS_HPP
@@ -0,0 +1,105 @@
+/* PlayfairCracker - Crack Playfair Encryptions
+ * Copyright (C) 2018 Yesha Maggi
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#ifndef NGRAMKERNEL_HPP
+#define NGRAMKERNEL_HPP
+
+#include "Fitness.hpp"
+#include <cstddef>
+
+/**
+ * @brief Loops over the n-gram windows of a text, specialized on n
+ * 
+ * Each window is indexed as in FrequencyCollector::ngramIndex(). With N known at
+ * 	compile time, the index of each window is a fixed sum of N letters, independent
+ * 	of the windows before it, so the loops unroll and vectorize. Fitness functions
+ * 	pick their kernels once, with indexKernel() and sumKernel(), when constructed.
+ * 	On x86 CPUs with AVX2, sumKernel() returns a kernel that indexes 8 windows at a
+ * 	time and gathers their table entries. It adds in the same order as
+ * 	sumWindows(), so both return exactly the same score.
+ * 	
+ * Text must be uppercase letters A to Z only, as returned by Key::decrypt().
+ */
+namespace NgramKernel {
+	/// Computes the index of each of windows n-gram windows of text into indices
+	typedef void (*IndexKernel)(const char *text, std::size_t windows, unsigned long *indices);
+	/// Returns the sum of table at the index of each of windows n-gram windows of text
+	typedef score_t (*SumKernel)(const score_t *table, const char *text, std::size_t windows);
+
+	template <unsigned N>
+	inline unsigned long index(const char *ngram) {
+		unsigned long index = 0;
+		for(unsigned i = 0; i < N; i++) {
+			index = index * 26 + (ngram[i] - 'A');
+		}
+		return index;
+	}
+
+	template <unsigned N>
+	void windowIndices(const char *text, std::size_t windows, unsigned long *indices) {
+		for(std::size_t pos = 0; pos < windows; pos++) {
+			indices[pos] = index<N>(text + pos);
+		}
+	}
+
+	/// Number of partial sums kept by sumWindows()
+	const unsigned SUM_LANES = 4;
+
+	/**
+	 * Finishes a sum over the windows from pos on, given partial sums of the windows
+	 * 	before it. Window pos is added to partial sum pos % SUM_LANES, and windows
+	 * 	past the last full group of SUM_LANES to the first. pos must be a multiple of
+	 * 	SUM_LANES.
+	 */
+	template <unsigned N>
+	inline score_t finishSum(const score_t *table, const char *text, std::size_t windows,
+			std::size_t pos, const score_t *sums) {
+		score_t sum0 = sums[0], sum1 = sums[1], sum2 = sums[2], sum3 = sums[3];
+		for(; pos + SUM_LANES <= windows; pos += SUM_LANES) {
+			sum0 += table[index<N>(text + pos)];
+			sum1 += table[index<N>(text + pos + 1)];
+			sum2 += table[index<N>(text + pos + 2)];
+			sum3 += table[index<N>(text + pos + 3)];
+		}
+		for(; pos < windows; pos++) {
+			sum0 += table[index<N>(text + pos)];
+		}
+		return (sum0 + sum1) + (sum2 + sum3);
+	}
+
+	/**
+	 * Independent partial sums keep several table lookups in flight instead of
+	 * 	waiting on one chain of additions. See finishSum().
+	 */
+	template <unsigned N>
+	score_t sumWindows(const score_t *table, const char *text, std::size_t windows) {
+		const score_t sums[SUM_LANES] = {0, 0, 0, 0};
+		return finishSum<N>(table, text, windows, 0, sums);
+	}
+
+	/// Kernel for n, or nullptr if n > MAX_TABLE_N
+	IndexKernel indexKernel(unsigned n);
+
+	/**
+	 * Kernel for n, or nullptr if n > MAX_TABLE_N. Uses the AVX2 kernel if simd is
+	 * 	true and the CPU supports it.
+	 */
+	SumKernel sumKernel(unsigned n, bool simd = true);
+
+	/// Returns true if sumKernel() can use the AVX2 kernel on this CPU
+	bool hasSimd();
+}
+
+#endif // NGRAMKERNEL_HPP
@@ -0,0 +1,127 @@
+/* PlayfairCracker - Crack Playfair Encryptions
+ * Copyright (C) 2018 Yesha Maggi
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#ifndef NGRAMTABLE_HPP
+#define NGRAMTABLE_HPP
+
+#include "FrequencyCollector.hpp"
+#include "PfHelpers.hpp"
+#include <cstdint>
+#include <vector>
+
+/// First bytes of every binary n-gram table file
+#define NGRAM_TABLE_MAGIC "PFNGRAM1"
+#define NGRAM_TABLE_MAGIC_SIZE 8
+
+/**
+ * @brief Header at the start of a binary n-gram table file
+ * 
+ * The header is followed by 26^n counts of type count_t, indexed as in
+ *  FrequencyCollector::ngramIndex(). Values are stored in the byte order of the
+ *  machine that wrote them.
+ */
+struct NgramTableHeader {
+	char magic[NGRAM_TABLE_MAGIC_SIZE];
+	std::uint32_t n;
+	std::uint32_t alphabet;
+	std::uint64_t totalCount;
+};
+
+/**
+ * @brief Read only view of a binary n-gram table file
+ * 
+ * Read only view of a binary n-gram table file, as written by
+ *  FrequencyCollector::writeNgramTable(). The file is memory mapped and the counts
+ *  are used in place, so loading takes no parsing no matter how large the table is.
+ *  
+ * @b Example: Convert a text n-gram file once, then load the table
+ * @code{.unparsed}
+ * ngramFrequency -b -n 4 -o quadgrams.bin corpus.txt
+ * @endcode
+ */
+class NgramTable {
+public:
+	/**
+	 * @param fileName  The binary n-gram table file to map
+	 * 
+	 * @throw std::ios_base::failure    fileName cannot be opened
+	 * @throw Exception                 fileName is not a valid n-gram table
+	 */
+	NgramTable(const char* fileName);
+	~NgramTable();
+
+	/**
+	 * @brief Returns N, the size of n-grams in the table
+	 * 
+	 * @return unsigned
+	 */
+	unsigned getN() const;
+
+	/**
+	 * @brief Returns the total count of all n-grams
+	 * 
+	 * @return count_t
+	 */
+	count_t getCount() const;
+
+	/**
+	 * @brief Returns the number of counts in the table, 26^n
+	 * 
+	 * @return unsigned long
+	 */
+	unsigned long size() const;
+
+	/**
+	 * @brief Returns the counts of every n-gram
+	 * 
+	 * Returns a pointer to size() counts, indexed by FrequencyCollector::ngramIndex().
+	 *  The pointer is valid for the lifetime of this object.
+	 * 
+	 * @return const count_t*
+	 */
+	const count_t *getCounts() const;
+
+	/**
+	 * @brief Get frequencies of all n-grams as a dense table
+	 * 
+	 * Same layout as FrequencyCollector::frequencyTable(). All 0.0 if the table
+	 *  has no counts.
+	 * 
+	 * @return vector<double>
+	 */
+	std::vector<double> frequencyTable() const;
+
+	/**
+	 * @brief Checks if a file starts with the n-gram table magic
+	 * 
+	 * Only the magic is checked. Returns false if the file cannot be read.
+	 * 
+	 * @param fileName  The file to be checked
+	 * @return bool
+	 */
+	static bool isTableFile(const char* fileName);
+
+private:
+	/// Mapping of the whole file
+	PfHelpers::MappedFile file;
+
+	/// Header at the start of the mapping
+	const NgramTableHeader *header;
+
+	/// Counts that follow the header
+	const count_t *counts;
+};
+
+#endif // NGRAMTABLE_HPP
@@ -0,0 +1,126 @@
+/* PlayfairCracker - Crack Playfair Encryptions
+ * Copyright (C) 2018 Yesha Maggi
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#ifndef PARENTSELECTION_HPP
+#define PARENTSELECTION_HPP
+
+#include "Fitness.hpp"
+#include "PlayfairGenetic.hpp"
+#include <utility>
+#include <vector>
+
+using std::vector;
+
+/** Indices in the population of two parents */
+typedef std::pair<unsigned, unsigned> parents_t;
+
+/**
+ * @namespace ParentSelection
+ * @brief Selection of the parents for the next generation.
+ * 
+ * Implements the SelectionType options of GenParams. Roulette selection builds the
+ * 	running sum of the weights once, and finds each parent with a binary search, so
+ * 	drawing many parents from a large population stays cheap. Tournament selection
+ * 	does not look at the whole population at all.
+ */
+namespace ParentSelection {
+	/**
+	 * @brief A roulette wheel over population scores
+	 * 
+	 * Each member gets a share of the wheel equal to its score minus the worst score,
+	 * 	so the worst member is never picked. If all scores are equal, all members
+	 * 	are equally likely instead.
+	 */
+	class RouletteWheel {
+	public:
+		/**
+		 * @param scores 	Fitness score of each member, at least 2 of them
+		 * @throw InvalidParameters if there are fewer than 2 scores
+		 */
+		RouletteWheel(const vector<score_t> &scores);
+		~RouletteWheel();
+
+		/**
+		 * @brief Pick one member
+		 * 
+		 * @param rng 		Reference to random number generator
+		 * @return 			Index of the member
+		 */
+		unsigned spin(rng_t &rng) const;
+
+		/**
+		 * @brief Pick one member other than exclude
+		 * 
+		 * The chances of the others are as if exclude had no share of the wheel.
+		 * 
+		 * @param rng 		Reference to random number generator
+		 * @param exclude 	Index of the member not to pick
+		 * @return 			Index of the member
+		 */
+		unsigned spin(rng_t &rng, unsigned exclude) const;
+
+		/**
+		 * @brief Pick count members by stochastic universal sampling
+		 * 
+		 * The wheel is spun once, with count evenly spaced pointers. The same member
+		 * 	can be picked more than once.
+		 * 
+		 * @param count 	Number of members to pick
+		 * @param rng 		Reference to random number generator
+		 * @param picked 	Cleared, then set to the indices of the members, in
+		 * 						ascending order
+		 * @return 			Reference to picked
+		 */
+		vector<unsigned>& sample(unsigned count, rng_t &rng, vector<unsigned> &picked) const;
+	private:
+		/// runningSum[i] is the sum of the shares of members 0 to i
+		vector<score_t> runningSum;
+
+		/// Share of the wheel of member index
+		score_t share(unsigned index) const;
+		/// First member whose running sum reaches target, from member first on
+		unsigned find(score_t target, unsigned first = 0) const;
+	};
+
+	/**
+	 * @brief Pick the best of size members drawn at random
+	 * 
+	 * @param scores 	Fitness score of each member
+	 * @param size 		Number of members drawn, with repeats
+	 * @param rng 		Reference to random number generator
+	 * @param exclude 	Index of a member that may not be drawn, or -1 for none
+	 * @return 			Index of the best member drawn. The first drawn wins a tie.
+	 */
+	unsigned tournament(const vector<score_t> &scores, unsigned size, rng_t &rng,
+			int exclude = -1);
+
+	/**
+	 * @brief Select the parent pairs for the next generation
+	 * 
+	 * Selects genParams.parentPairs pairs (at least 1) with the method in
+	 * 	genParams.selection. The two parents of a pair are always different members.
+	 * 
+	 * @param scores 	Fitness score of each member, at least 2 of them
+	 * @param genParams Reference to GenParams
+	 * @param rng 		Reference to random number generator
+	 * @param pairs 	Cleared, then set to the parent pairs
+	 * @return 			Reference to pairs
+	 * @throw InvalidParameters for an unknown selection or fewer than 2 scores
+	 */
+	vector<parents_t>& selectParents(const vector<score_t> &scores, const GenParams &genParams,
+			rng_t &rng, vector<parents_t> &pairs);
+}
+
+#endif
@@ -79,6 +79,28 @@ namespace PfHelpers {
 		
 		std::chrono::time_point<clock_t> m_beg;	
 	};
+
+	/**
+	 * @brief Read only memory map of a whole file
+	 * 
+	 * Maps fileName into memory for as long as the object lives. An empty file
+	 * 	maps to data() == nullptr and size() == 0.
+	 * 
+	 * @throw std::ios_base::failure	fileName cannot be opened or mapped
+	 */
+	class MappedFile {
+	public:
+		MappedFile(const char* fileName);
+		~MappedFile();
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		const char* data() const;
+		std::size_t size() const;
+	private:
+		const char* m_data;
+		std::size_t m_size;
+	};
 }
 
 
@@ -15,10 +15,9 @@
 #ifndef PLAYFAIRGENETIC_HPP
 #define PLAYFAIRGENETIC_HPP
 
-#include "EnglishFitness.hpp"
+#include "Fitness.hpp"
 #include "Key.hpp"
 #include "pcg_random.hpp"
-#include <list>
 
 using std::vector;
 using std::string;
@@ -28,6 +27,8 @@ typedef pcg32 rng_t;
 /** Population type */
 typedef vector<string> pop_t;
 
+class ScoreCache;
+
 /**
  * The mutation function to be used. Each child is guaranteed to be mutated.
  */
@@ -42,6 +43,27 @@ enum MutationType {
 	INVERSION
 };
 
+/**
+ * How the parents are selected from the population. See ParentSelection.
+ */
+enum SelectionType {
+	/**
+	 * Each parent is drawn with a chance proportional to its score above the
+	 * 	worst score.
+	 */
+	ROULETTE,
+	/**
+	 * Stochastic universal sampling. Like ROULETTE, but all parents are taken in
+	 * 	one spin with evenly spaced pointers, so members are picked close to
+	 * 	their expected number of times.
+	 */
+	SUS,
+	/**
+	 * Each parent is the best of tournamentSize members drawn at random.
+	 */
+	TOURNAMENT
+};
+
 /**
  * @brief Parameters applied to each generation.
  * 
@@ -49,7 +71,7 @@ enum MutationType {
  * 	to each generation.
  */
 struct GenParams {
-	/** The number of children produced */
+	/** The number of children produced, shared out between the parent pairs in turn */
 	unsigned numChildren;
 	/** The number of randomized keys added to population */
 	unsigned newRandom;
@@ -66,6 +88,17 @@ struct GenParams {
 	 * 	Aside from these best, only the parents and children continue.
 	 */
 	unsigned keepBest;
+	/** see SelectionType */
+	unsigned selection;
+	/** The number of members in each tournament for TOURNAMENT selection. 0 means 2. */
+	unsigned tournamentSize;
+	/**
+	 * The number of parent pairs selected each generation. Parents only form pairs
+	 * 	with different members, but one member may be in several pairs. 0 means 1.
+	 * 	Each distinct parent continues once, so a generation holds between 2 and
+	 * 	2 * parentPairs parents besides the children, random keys and best members.
+	 */
+	unsigned parentPairs;
 };
 
 /**
@@ -86,7 +119,8 @@ namespace PlayfairGenetic {
 	/**
 	 * @brief Initialize a population randomly
 	 * 
-	 * Initializes a population of random keys
+	 * Initializes a population of random keys, no two of which are rotations of
+	 * 	the same square
 	 * 
 	 * @param popSize 		Size of population to be built
 	 * @param population 	Reference to population, will be cleared and resized
@@ -102,6 +136,8 @@ namespace PlayfairGenetic {
 	 * 	with the remaining letters randomized.
 	 * 	
 	 * For example: If seed is 'Apple', each member will start with 'APLE'.
+	 * 	Members are rotations of different squares, unless the seed leaves too few
+	 * 	of them to fill the population.
 	 * 
 	 * @param popSize 		Size of population to be built
 	 * @param population 	Reference to population, will be cleared and resized
@@ -119,21 +155,31 @@ namespace PlayfairGenetic {
 	 * 1. Get fitness scores for each member, using decrypted cipherText
 	 * 2. Kill off worst members
 	 * 3. Copy and save best members
-	 * 4. Select two different members to be the parents, kill off everyone else
+	 * 4. Select pairs of different members to be the parents, kill off everyone else.
+	 * 		A member in several pairs is kept once.
 	 * 5. Produce children
 	 * 6. Mutate parents and children
 	 * 7. Add random keys to population
-	 * 8. Add best members from step 3 to population
+	 * 8. Mutate again any member equivalent to another (see Key::canonicalKey())
+	 * 9. Add best members from step 3 to population
 	 * 
-	 * @param englishFit 	Reference to EnglishFitness class to be used for fitness function 
+	 * @param fitness 		Reference to Fitness class to be used for fitness function 
 	 * @param cipherText 	Reference to the cipherText
 	 * @param genParams 	Reference to GenParams
 	 * @param population 	Reference to population
 	 * @param rng 			Reference to random number generator
+	 * @param threads 		Number of threads the population is scored on
+	 * @param scores 		Optional. If not empty, the fitness scores of population,
+	 * 							which are used in step 1 instead of scoring it again.
+	 * 							Set to the fitness scores of the returned population,
+	 * 							so they can be passed back for the next generation.
+	 * @param cache 		Optional. Scores of keys seen before are taken from it
+	 * 							instead of decrypting, and new scores are added
 	 * @return 				Reference to population
 	 */
-	pop_t& nextGeneration(const EnglishFitness &englishFit, const vector<char> &cipherText,
-			const GenParams &genParams,	pop_t &population, rng_t &rng);
+	pop_t& nextGeneration(const Fitness &fitness, const vector<char> &cipherText,
+			const GenParams &genParams,	pop_t &population, rng_t &rng, unsigned threads = 1,
+			vector<score_t> *scores = nullptr, ScoreCache *cache = nullptr);
 
 	/**
 	 * @brief Get the key and score for the most fit member
@@ -151,15 +197,36 @@ namespace PlayfairGenetic {
 	/**
 	 * @brief Calculate the fitness scores for a population
 	 * 
-	 * Calculate the fitness scores for a population with the given cipherText
+	 * Calculate the fitness scores for a population with the given cipherText.
+	 * 	The population is split into contiguous slices that are scored in parallel,
+	 * 	each thread with its own decryption buffer. Scores do not depend on the
+	 * 	number of threads.
 	 * 
-	 * @param englishFit 	Reference to EnglishFitness class to be used for fitness function
+	 * @param fitness 		Reference to Fitness class to be used for fitness function
 	 * @param population 	Reference to population
 	 * @param cipherText 	Reference to the cipherText
-	 * @return 				Reference to population
+	 * @param threads 		Number of threads to score on
+	 * @param cache 		Optional. Scores of keys seen before are taken from it
+	 * 							instead of decrypting, and new scores are added
+	 * @return 				Fitness score of each member, in population order
+	 */
+	vector<score_t> fitScores(const Fitness &fitness, const pop_t &population, 
+			const vector<char> &cipherText, unsigned threads = 1, ScoreCache *cache = nullptr);
+
+	/**
+	 * @brief Exchange the best keys between islands
+	 * 
+	 * Exchange the best keys between islands, which are populations evolved
+	 * 	separately. Islands form a ring: the best member of each island replaces
+	 * 	the worst member of the next one, unless that island already holds a key
+	 * 	equivalent to it (see Key::canonicalKey()). All migrants are picked before
+	 * 	any is placed, and the scores are updated to match.
+	 * 
+	 * @param islands 		Reference to the islands
+	 * @param scores 		Reference to fitness scores of each island
+	 * @return 				Reference to islands
 	 */
-	vector<score_t> fitScores(const EnglishFitness &englishFit, const pop_t &population, 
-			const vector<char> &cipherText);
+	vector<pop_t>& migrate(vector<pop_t> &islands, vector<vector<score_t>> &scores);
 }	
 
 #endif // PLAYFAIRGENETIC_HPP
\ No newline at end of file
@@ -0,0 +1,100 @@
+/* PlayfairCracker - Crack Playfair Encryptions
+ * Copyright (C) 2018 Yesha Maggi
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#ifndef SCORECACHE_HPP
+#define SCORECACHE_HPP
+
+#include "Fitness.hpp"
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Number of independently locked parts of a ScoreCache. Threads scoring different
+ *  keys rarely wait on each other.
+ */
+#define SCORE_CACHE_SHARDS 16
+
+/**
+ * @brief Remembers the fitness scores of keys
+ * 
+ * A bounded cache of scores, safe to use from many threads at once. Keys are
+ *  stored by Key::canonicalKey(), so a key and all its row and column rotations, which
+ *  decrypt the same, share one entry.
+ * 
+ * The cache is split into SCORE_CACHE_SHARDS shards, each with its own lock and an
+ *  equal share of the capacity. A full shard forgets its oldest entry first.
+ * 
+ * @attention A cache holds scores for one Fitness and one cipherText. Use a new
+ *  cache (or clear()) when either changes.
+ */
+class ScoreCache {
+public:
+	/**
+	 * @param capacity 	The most scores held at once, rounded up to a multiple of
+	 * 						SCORE_CACHE_SHARDS
+	 */
+	ScoreCache(std::size_t capacity);
+	~ScoreCache();
+
+	/**
+	 * @brief Look up the score of a key
+	 * 
+	 * @param square 	The key, as returned by Key::canonicalKey()
+	 * @param score 	Set to the score of square, if found
+	 * @return 			True if the score of square is held
+	 */
+	bool find(const std::string &square, score_t &score);
+
+	/**
+	 * @brief Remember the score of a key
+	 * 
+	 * @param square 	The key, as returned by Key::canonicalKey()
+	 * @param score 	Its fitness score
+	 */
+	void insert(const std::string &square, score_t score);
+
+	/**
+	 * @brief Forget all scores. The hit and miss counts are kept.
+	 */
+	void clear();
+
+	/** @brief Number of scores held */
+	std::size_t size();
+	/** @brief Number of calls to find() that found a score */
+	unsigned long hits() const;
+	/** @brief Number of calls to find() that did not */
+	unsigned long misses() const;
+private:
+	struct Shard {
+		std::mutex lock;
+		std::unordered_map<std::string, score_t> scores;
+		/// Keys in the order they were inserted, overwritten oldest first when full
+		std::vector<std::string> order;
+		std::size_t oldest = 0;
+	};
+
+	std::size_t shardCapacity;
+	std::vector<Shard> shards;
+	std::atomic<unsigned long> hitCount;
+	std::atomic<unsigned long> missCount;
+
+	/// Returns the shard that square is stored in
+	Shard &shardOf(const std::string &square);
+};
+
+#endif
@@ -0,0 +1,88 @@
+/* PlayfairCracker - Crack Playfair Encryptions
+ * Copyright (C) 2018 Yesha Maggi
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef SIMULATEDANNEALING_HPP
+#define SIMULATEDANNEALING_HPP
+
+#include "Fitness.hpp"
+#include "Key.hpp"
+#include "PlayfairGenetic.hpp"
+
+using std::vector;
+using std::string;
+
+/**
+ * @brief Parameters for a simulated annealing run.
+ * 
+ * The temperature starts at temperature, and is lowered by step after every count
+ * 	keys tried, until it reaches 0.
+ */
+struct AnnealParams {
+	/** The starting temperature */
+	double temperature;
+	/** How much the temperature is lowered each time */
+	double step;
+	/** The number of keys tried at each temperature */
+	unsigned count;
+};
+
+/**
+ * @namespace SimulatedAnnealing
+ * @brief Simulated annealing to crack English Playfair encryptions.
+ * 
+ * A single key is repeatedly modified. A modified key that scores better is always
+ * 	kept, and one that scores worse by d is kept with probability exp(-d / T) where T
+ * 	is the current temperature. The modifications are the classic Playfair moves:
+ * 	
+ * @li 	Swap two letters (most of the time)
+ * @li 	Swap two rows
+ * @li 	Swap two columns
+ * @li 	Flip the square top to bottom
+ * @li 	Flip the square left to right
+ * @li 	Reverse the key
+ * 
+ * Letter swaps are rescored with Key::decryptSwap() and Fitness::rescore(), so only
+ * 	the changed part of the decryption is looked at. Works best with LogFitness,
+ * 	whose scores have a suitable scale for the default temperatures.
+ */
+namespace SimulatedAnnealing {
+	/**
+	 * @brief Run simulated annealing from a starting key
+	 * 
+	 * Run one full temperature schedule starting from key.
+	 * 
+	 * @param fitness 		Reference to Fitness class to be used for fitness function
+	 * @param cipherText 	Reference to the cipherText
+	 * @param params 		Reference to AnnealParams
+	 * @param key 			The starting key, 25 letters
+	 * @param rng 			Reference to random number generator
+	 * @return 				The best key found and its score
+	 */
+	std::pair<string, score_t> anneal(const Fitness &fitness, const vector<char> &cipherText,
+			const AnnealParams &params, string key, rng_t &rng);
+
+	/**
+	 * @brief Apply a random move to a key
+	 * 
+	 * Applies one of the moves other than a letter swap to key, chosen with equal
+	 * 	probability.
+	 * 
+	 * @param key 			The key to modify, 25 letters
+	 * @param rng 			Reference to random number generator
+	 * @return 				Reference to key
+	 */
+	string& shuffleKey(string &key, rng_t &rng);
+}
+
+#endif // SIMULATEDANNEALING_HPP
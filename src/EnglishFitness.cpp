@@ -15,8 +15,30 @@
 #include "EnglishFitness.hpp"
 #include "PfHelpers.hpp"
 #include <algorithm>
+#include <cmath>
+
+EnglishFitness::EnglishFitness(const FrequencyCollector &standardFreq, FitnessMode mode):
+	sTable{}, sCount{standardFreq.getCount()}, sSquares{0}, n{standardFreq.getN()}, mode{mode},
+	indexWindows{NgramKernel::indexKernel(standardFreq.getN())} {
+		if(!standardFreq.isEmpty()) {
+			sTable = standardFreq.frequencyTable();
+		}
+		for(unsigned long index = 0; index < sTable.size(); index++) {
+			sSquares += sTable[index] * sTable[index];
+		}
+	}
+
+EnglishFitness::EnglishFitness(const NgramTable &standardTable, FitnessMode mode):
+	sTable{}, sCount{standardTable.getCount()}, sSquares{0}, n{standardTable.getN()}, mode{mode},
+	indexWindows{NgramKernel::indexKernel(standardTable.getN())} {
+		if(sCount) {
+			sTable = standardTable.frequencyTable();
+		}
+		for(unsigned long index = 0; index < sTable.size(); index++) {
+			sSquares += sTable[index] * sTable[index];
+		}
+	}
 
-EnglishFitness::EnglishFitness(const FrequencyCollector &standardFreq): sFreq{standardFreq}, n{standardFreq.getN()} {}
 EnglishFitness::~EnglishFitness() {}
 
 score_t EnglishFitness::fitness(const FrequencyCollector &testFreq) const {
@@ -25,43 +47,35 @@ score_t EnglishFitness::fitness(const FrequencyCollector &testFreq) const {
 	
 	// frequency = 1 / sum{|S - T|^2}
 
-	unsigned n = sFreq.getN();
 	score_t fitness = 0;
-	if(sFreq.isEmpty() || testFreq.isEmpty()) {
+	if(sTable.empty() || testFreq.isEmpty()) {
 		throw Exception("Error: A frequency map is empty");
 	}
 	if(testFreq.getN() != n) {
 		throw Exception("Error: Frequencies have different n values");
 	}
 
-	//  Iterate through all permutations of n letters
-	//  perms[] is used like an odometer
-	int *perms = new int[n] ();
-	int max = std::pow(26,n);
-	for(int i = 0; i < max; i++) {
-		string perm;
-		for(unsigned index = 0; index < n; index++) {
-			perm.push_back(65 + perms[index]);
+	if(mode == SPARSE) {
+		//  Where T = 0 the term is just S^2, which is already in sSquares.
+		//  So only correct the terms for n-grams that the test text contains.
+		fitness = sSquares;
+		const double testCount = testFreq.getCount();
+		const auto &counts = testFreq.getCounts();
+		for(auto it = counts.begin(); it != counts.end(); ++it) {
+			if(!FrequencyCollector::tableNgram(it->first.data(), n)) continue;
+			double standardF = sTable[FrequencyCollector::ngramIndex(it->first.data(), n)];
+			double diff = standardF - it->second / testCount;
+			fitness += diff * diff - standardF * standardF;
 		}
-		//  Increment perms
-		perms[0] = (perms[0] + 1) % 26;
-		//  Check if 'odometer' rolls over
-		for(unsigned index = 1; index < n; index++) {
-			if(perms[index - 1] == 0) {
-				perms[index] = (perms[index] + 1) % 26;
-			} else {
-				break;
-			}
+	} else {
+		//  Both tables are indexed the same way, so every permutation of n letters
+		//  is just a position in the arrays
+		vector<double> tTable = testFreq.frequencyTable();
+		for(unsigned long index = 0; index < sTable.size(); index++) {
+			double diff = sTable[index] - tTable[index];
+			fitness += diff * diff;
 		}
-		
-		//  Collect the standard and test freq of permutation
-		double standardF = sFreq.frequency(perm);
-		double testF = testFreq.frequency(perm);
-
-		//  Add to fitness score
-		fitness += std::pow(std::abs(standardF - testF), 2);
 	}
-	delete[] perms;
 	if(!fitness) {
 		// Can't divide by 0
 		return 0;
@@ -70,13 +84,56 @@ score_t EnglishFitness::fitness(const FrequencyCollector &testFreq) const {
 	return 1 / fitness;
 }
 
+score_t EnglishFitness::score(const std::vector<char> &text) const {
+	if(sTable.empty() || text.size() < n) {
+		throw Exception("Error: A frequency map is empty");
+	}
+
+	//  Index every window straight from the letters, no FrequencyCollector needed
+	const std::size_t windows = text.size() - n + 1;
+	std::vector<unsigned long> indices(windows);
+	indexWindows(text.data(), windows, indices.data());
+	const double testCount = windows;
+
+	score_t fitness = 0;
+	if(mode == SPARSE) {
+		//  Equal indices are adjacent once sorted, each run is one n-gram and its count
+		std::sort(indices.begin(), indices.end());
+		fitness = sSquares;
+		for(std::size_t first = 0, last; first < windows; first = last) {
+			for(last = first + 1; last < windows && indices[last] == indices[first]; last++);
+			double standardF = sTable[indices[first]];
+			double diff = standardF - (last - first) / testCount;
+			fitness += diff * diff - standardF * standardF;
+		}
+	} else {
+		std::vector<unsigned> counts(sTable.size(), 0);
+		for(std::size_t pos = 0; pos < windows; pos++) {
+			++counts[indices[pos]];
+		}
+		for(unsigned long index = 0; index < sTable.size(); index++) {
+			double diff = sTable[index] - counts[index] / testCount;
+			fitness += diff * diff;
+		}
+	}
+	if(!fitness) {
+		// Can't divide by 0
+		return 0;
+	}
+	return 1 / fitness;
+}
+
 unsigned EnglishFitness::getN() const {
 	return n;
 }
 
+FitnessMode EnglishFitness::getMode() const {
+	return mode;
+}
+
 score_t EnglishFitness::maxFitness(const FrequencyCollector &testFreq) const {
 	count_t testCount = testFreq.getCount();
-	count_t standardCount = sFreq.getCount();
+	count_t standardCount = sCount;
 
 	return 1/(2*std::pow(2*std::abs((1.0/testCount)-(1.0/standardCount)), 2));
 }
\ No newline at end of file
@@ -13,14 +13,124 @@
  */
 
 #include "FrequencyCollector.hpp"
+#include "NgramKernel.hpp"
+#include "NgramTable.hpp"
 #include "PfHelpers.hpp"
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include <string.h>
-#include <regex>
+#include <thread>
+
+namespace {
+	enum LineStatus { LINE_SKIP, LINE_OK, LINE_BAD_COUNT };
+
+	/// One parsed line of an n-gram count file. ngram points into the file.
+	struct CountLine {
+		const char *ngram;
+		std::size_t length;
+		count_t count;
+		/// One past the last digit of the count
+		const char *countEnd;
+	};
+
+	inline bool isBlank(char ch) {
+		return ch == ' ' || ch == '\t' || ch == '\r';
+	}
+
+	/**
+	 * Splits the line [pos, end) into an n-gram and its count, the same way as
+	 * 	reading two words with operator>>. Blank lines and comments starting with
+	 * 	'/' are skipped. Anything after the count is ignored.
+	 */
+	LineStatus parseCountLine(const char *pos, const char *end, CountLine &line) {
+		if(pos == end || *pos == '/') return LINE_SKIP;
+		while(pos < end && isBlank(*pos)) ++pos;
+		if(pos == end) return LINE_SKIP;
+
+		line.ngram = pos;
+		while(pos < end && !isBlank(*pos)) ++pos;
+		line.length = pos - line.ngram;
+
+		while(pos < end && isBlank(*pos)) ++pos;
+		if(pos == end || *pos < '0' || *pos > '9') return LINE_BAD_COUNT;
+		line.count = 0;
+		for(; pos < end && *pos >= '0' && *pos <= '9'; ++pos) {
+			line.count = line.count * 10 + (*pos - '0');
+		}
+		line.countEnd = pos;
+		return LINE_OK;
+	}
+
+	/**
+	 * Checks a line parsed by parseCountLine() is exactly n letters, one space and
+	 * 	a number, as validNgramFile() requires.
+	 */
+	bool strictCountLine(const char *pos, const char *end, const CountLine &line, unsigned n) {
+		if(line.ngram != pos || line.length != n) return false;
+		for(unsigned i = 0; i < n; i++) {
+			if(!isalpha(static_cast<unsigned char>(line.ngram[i]))) return false;
+		}
+		return line.ngram[n] == ' ' && line.ngram + n + 1 < end &&
+			line.ngram[n + 1] >= '0' && line.ngram[n + 1] <= '9' && line.countEnd == end;
+	}
+
+	/// isalpha() in the "C" locale, but never true for letters outside A to Z
+	inline bool isLetter(char ch) {
+		return (ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z');
+	}
+
+	/// Inverse of FrequencyCollector::ngramIndex(), written into ngram of size n
+	void indexNgram(unsigned long index, unsigned n, ngram_t &ngram) {
+		for(unsigned i = n; i-- > 0; ) {
+			ngram[i] = 'A' + index % 26;
+			index /= 26;
+		}
+	}
+
+	inline unsigned letterIndex(char ch) {
+		return toupper(static_cast<unsigned char>(ch)) - 'A';
+	}
+
+	/**
+	 * Counts into table every n-gram whose last letter lies in [first, last). The
+	 * 	window is primed with the n-1 letters before first, found by walking back
+	 * 	towards begin, so n-grams that span two ranges are counted exactly once.
+	 * 	Returns the number of n-grams counted.
+	 */
+	count_t countRange(const char *begin, const char *first, const char *last, unsigned n,
+			std::vector<count_t> &table) {
+		const unsigned long high = table.size() / 26;
+		unsigned long index = 0;
+		unsigned filled = 0;
+		unsigned long scale = 1;
+		for(const char *pos = first; pos > begin && filled < n - 1; ) {
+			--pos;
+			if(!isLetter(*pos)) continue;
+			index += letterIndex(*pos) * scale;
+			scale *= 26;
+			++filled;
+		}
+
+		count_t counted = 0;
+		for(const char *pos = first; pos < last; ++pos) {
+			if(!isLetter(*pos)) continue;
+			index = (index % high) * 26 + letterIndex(*pos);
+			if(filled < n - 1) {
+				++filled;
+				continue;
+			}
+			++table[index];
+			++counted;
+		}
+		return counted;
+	}
+}
 
 FrequencyCollector::FrequencyCollector(unsigned N) :
 	n{N}, totalCount{0}, freqs{} {
@@ -39,81 +149,78 @@ FrequencyCollector::FrequencyCollector(unsigned N) :
 FrequencyCollector::~FrequencyCollector() {}
 
 bool FrequencyCollector::validNgramFile(const char* fileName) {
-	std::ifstream fileReader(fileName);
-	if(fileReader.fail()) {
+	std::unique_ptr<PfHelpers::MappedFile> file;
+	try {
+		file.reset(new PfHelpers::MappedFile(fileName));
+	} catch(const std::ios_base::failure &e) {
 		std::cerr << "Failed to open: " << fileName << '\n';
 		return false;
 	}
 
-	std::unordered_map<ngram_t, count_t> NGrams;
-	long lineNum = 1;
-	while(!fileReader.eof()) {
-		std::string line, ngramString, countString;
-		std::getline(fileReader, line);
-		if(line.empty() || line.at(0) == '/') continue;
+	const char *pos = file->data();
+	const char *end = pos + file->size();
+	std::unordered_set<ngram_t> ngrams;
+	ngrams.reserve(file->size() / (n + 3));
+	ngram_t ngram;
+	CountLine line;
+	bool valid = true;
+	for(unsigned long lineNum = 1; pos < end; lineNum++) {
+		const char *lineEnd = static_cast<const char*>(memchr(pos, '\n', end - pos));
+		if(!lineEnd) lineEnd = end;
+		const char *lineStart = pos;
+		LineStatus status = parseCountLine(pos, lineEnd, line);
+		pos = lineEnd + 1;
+		if(status == LINE_SKIP && (lineStart == lineEnd || *lineStart == '/')) continue;
 
-		std::regex format("^[[:alpha:]]{" + std::to_string(n) + "} [[:digit:]]+$");
-		if(!std::regex_match(line, format)) {
-			std::cerr << "Line " << lineNum << " of " << fileName << "is of wrong format\n";
-			return false;
+		//	Stricter than readNgramCount(): "[n-gram] [number]" with a single space
+		//	and nothing else on the line
+		if(status != LINE_OK || !strictCountLine(lineStart, lineEnd, line, n)) {
+			std::cerr << "Line " << lineNum << " of " << fileName << " is of wrong format\n";
+			valid = false;
+			continue;
 		}
 
-		ngram_t ngram = line.substr(0,n);
-		if(NGrams.find(ngram) != NGrams.end()) {
-			std::cerr << "Line " << lineNum << " of " <<fileName << "has duplicate: " <<
+		ngram.assign(line.ngram, line.length);
+		if(!ngrams.insert(ngram).second) {
+			std::cerr << "Line " << lineNum << " of " << fileName << " has duplicate: " <<
 				ngram << '\n';
-			return false;
+			valid = false;
 		}
-		NGrams.insert(std::make_pair(ngram, 0));
-
-		++ lineNum;
 	}
-	return true;
+	return valid;
 }
 
 int FrequencyCollector::readNgramCount(const char* fileName) {
-	unsigned long numLines;
-	try {
-		numLines = numFileLines(fileName);
-	} catch (const std::ifstream::failure e) {
-		std::cerr << e.what() << '\n';
-		throw;
-	}
-	
-	freqs.reserve(numLines);
+	//	Parse the mapped file in place, one pass and no per-line strings
+	PfHelpers::MappedFile file(fileName);
+	const char *pos = file.data();
+	const char *end = pos + file.size();
+	//	Every line holds at least an n-gram, a space, a digit and a newline
+	freqs.reserve(freqs.size() + file.size() / (n + 3));
 
-	std::ifstream fileReader(fileName);
-	if(fileReader.fail()) {
-		string e = "Failed to open: ";
-		e += fileName;
-		throw std::ios_base::failure(e.c_str());
-	}
-	
-	while(!fileReader.eof()) {
-		//	Read each line, split line into - n-gram and count
-		std::string line, ngramString, countString;
-		std::getline(fileReader, line);
-		if(line.empty() || line.at(0) == '/') continue;
-		// 	Split the line
-		std::stringstream ss(line);
-		ss >> ngramString;
-		ss >> countString;
-		count_t count = std::stoi(countString);
-
-		totalCount += count;
+	ngram_t ngram;
+	CountLine line;
+	while(pos < end) {
+		const char *lineEnd = static_cast<const char*>(memchr(pos, '\n', end - pos));
+		if(!lineEnd) lineEnd = end;
+		LineStatus status = parseCountLine(pos, lineEnd, line);
+		pos = lineEnd + 1;
+		if(status == LINE_SKIP) continue;
+		if(status == LINE_BAD_COUNT) {
+			throw Exception("Error: Invalid count in n-gram file");
+		}
 
 		// 	If the n-gram read was of the wrong length.
-		if(ngramString.size() != n) {
+		if(line.length != n) {
 			std::cerr << "Ngram length contradiction!" << '\n';
-			std::cerr << "  Ngram read from " << fileName << " was of length: " << ngramString.size() << '\n';
+			std::cerr << "  Ngram read from " << fileName << " was of length: " << line.length << '\n';
 			std::cerr << "  Ngram length expected: " << n << '\n';
 			throw Exception("Error: Ngram length contradiction");
 		}
-		
-		if(freqs.find(ngramString) == freqs.end()) {
-			freqs.insert(std::make_pair(ngramString, 0));
-		}
-		freqs.at(ngramString) += count;
+
+		totalCount += line.count;
+		ngram.assign(line.ngram, line.length);
+		freqs[ngram] += line.count;
 	}
 	return 0;
 }
@@ -130,6 +237,51 @@ int FrequencyCollector::writeNGramCount(const char* fileName) {
 	return 0;
 }
 
+int FrequencyCollector::readNgramTable(const char* fileName) {
+	NgramTable table(fileName);
+	if(table.getN() != n) {
+		std::cerr << "Ngram length contradiction!" << '\n';
+		std::cerr << "  Ngram table " << fileName << " has length: " << table.getN() << '\n';
+		std::cerr << "  Ngram length expected: " << n << '\n';
+		throw Exception("Error: Ngram length contradiction");
+	}
+
+	*this += table;
+	return 0;
+}
+
+int FrequencyCollector::writeNgramTable(const char* fileName) const {
+	if(n > MAX_TABLE_N) {
+		throw InvalidParameters("N is too large for a frequency table");
+	}
+	std::vector<count_t> counts(tableSize(n), 0);
+	for(auto it = freqs.begin(); it != freqs.end(); ++it) {
+		if(!tableNgram(it->first.data(), n)) continue;
+		counts[ngramIndex(it->first.data(), n)] = it->second;
+	}
+
+	NgramTableHeader header;
+	memcpy(header.magic, NGRAM_TABLE_MAGIC, NGRAM_TABLE_MAGIC_SIZE);
+	header.n = n;
+	header.alphabet = 26;
+	header.totalCount = totalCount;
+
+	std::ofstream fileWriter(fileName, std::ofstream::binary);
+	if(fileWriter.fail()) {
+		string e = "Failed to open: ";
+		e += fileName;
+		throw std::ios_base::failure(e.c_str());
+	}
+	fileWriter.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	fileWriter.write(reinterpret_cast<const char*>(counts.data()), counts.size() * sizeof(count_t));
+	if(fileWriter.fail()) {
+		string e = "Failed to write: ";
+		e += fileName;
+		throw std::ios_base::failure(e.c_str());
+	}
+	return 0;
+}
+
 int FrequencyCollector::setNGramCount(const char* fileRead, const char* fileWrite) {
 	this->clear();
 	collectNGramsFile(fileRead);
@@ -137,61 +289,212 @@ int FrequencyCollector::setNGramCount(const char* fileRead, const char* fileWrit
 	return 0;
 }
 
-int FrequencyCollector::collectNGramsFile(const char fileName[]) {
-	std::ifstream fileReader(fileName);
+int FrequencyCollector::collectNGramsFile(const char fileName[], std::size_t chunkSize) {
+	std::ifstream fileReader(fileName, std::ifstream::binary);
 	if(fileReader.fail()) {
 		string e = "Failed to open: ";
 		e += fileName;
 		throw std::ios_base::failure(e.c_str());
 	}
+	if(chunkSize == 0) {
+		throw InvalidParameters("Chunk size must be greater than 0");
+	}
+
+	//	Only one chunk is held at a time. The window carries the last n-1 letters
+	//	into the next chunk, so n-grams spanning a boundary are still counted.
+	std::vector<char> chunk(chunkSize);
+	ngram_t window(n, ' ');
+	unsigned filled = 0;
+	while(fileReader.read(chunk.data(), chunk.size()) || fileReader.gcount() > 0) {
+		collectChunk(chunk.data(), fileReader.gcount(), window, filled);
+	}
+	return 0;
+}
+
+int FrequencyCollector::collectNGramsFiles(const std::vector<const char*> &fileNames,
+		unsigned threads) {
+	//	Dense tables only pay off with several threads and a table of manageable size.
+	//	Each thread holds a whole table, so no more threads than the budget allows.
+	if(n <= MAX_TABLE_N) {
+		threads = std::min<unsigned long>(threads,
+			MAX_COLLECT_TABLE_BYTES / (tableSize(n) * sizeof(count_t)));
+	}
+	if(threads <= 1 || n > MAX_TABLE_N) {
+		for(auto it = fileNames.begin(); it != fileNames.end(); ++it) {
+			collectNGramsFile(*it);
+		}
+		return 0;
+	}
 
-	std::stringstream buffer;
-	buffer << fileReader.rdbuf();
+	std::vector<std::vector<count_t>> tables(threads, std::vector<count_t>(tableSize(n), 0));
+	std::vector<count_t> counted(threads, 0);
+	for(auto it = fileNames.begin(); it != fileNames.end(); ++it) {
+		PfHelpers::MappedFile file(*it);
+		const char *begin = file.data();
+		const std::size_t size = file.size();
 
-	collectNGrams(buffer);
+		//	Each thread counts the n-grams ending in its own slice of the file
+		std::vector<std::thread> workers;
+		for(unsigned t = 0; t < threads; t++) {
+			workers.emplace_back([&, t]() {
+				counted[t] += countRange(begin, begin + size * t / threads,
+					begin + size * (t + 1) / threads, n, tables[t]);
+			});
+		}
+		for(auto worker = workers.begin(); worker != workers.end(); ++worker) {
+			worker->join();
+		}
+	}
+
+	//	Merge the per-thread tables
+	for(unsigned t = 1; t < threads; t++) {
+		for(unsigned long index = 0; index < tables[0].size(); index++) {
+			tables[0][index] += tables[t][index];
+		}
+		counted[0] += counted[t];
+	}
+	addTable(tables[0].data(), counted[0]);
 	return 0;
 }
 
 int FrequencyCollector::collectNGrams(std::stringstream &buffer) {
-	// 	Read stream 1 letter at a time and add them to this queue
-	// 	Queue will "rotate" as letters get added
-	char *queue = new char[n] ();
-	//	Keep track of the current start of the queue
-	unsigned curPos = 0;
-	// 	This first while-loop is just to fill up the queue
-	//	Collect the first N letters before adding the ngram to map
-	char ch;
-	while(buffer.get(ch)) {
-		if(!isalpha(ch)) continue;
-		queue[curPos++] = toupper(ch);
-		// 	Fill up the queue before adding ngrams to map
-		if(curPos >= n-1) break;
-	}
-	// 	Read buffer one character at a time
-	while(buffer.get(ch)) {
+	//	Called for every fitness score, so a small chunk on the stack rather than
+	//	allocating COLLECT_CHUNK_SIZE
+	char chunk[4096];
+	ngram_t window(n, ' ');
+	unsigned filled = 0;
+	while(buffer.read(chunk, sizeof(chunk)) || buffer.gcount() > 0) {
+		collectChunk(chunk, buffer.gcount(), window, filled);
+	}
+	return 0;
+}
+
+int FrequencyCollector::collectNGrams(const char *text, std::size_t size) {
+	for(std::size_t pos = 0; pos < size; pos++) {
+		if(text[pos] < 'A' || text[pos] > 'Z')
+			throw Exception("Error: text must only hold uppercase letters");
+	}
+	if(size < n)
+		return 0;
+
+	//	Every window is a whole n-gram, so they are indexed together and counted
+	//	in a dense table rather than one string at a time
+	std::size_t windows = size - n + 1;
+	std::vector<unsigned long> indices(windows);
+	NgramKernel::IndexKernel kernel = NgramKernel::indexKernel(n);
+	if(kernel) {
+		kernel(text, windows, indices.data());
+	} else {
+		for(std::size_t pos = 0; pos < windows; pos++) {
+			indices[pos] = ngramIndex(text + pos, n);
+		}
+	}
+
+	//	A dense table only pays off when the text fills a fair part of it. Short
+	//	text, and any n without a table, is sorted and counted run by run instead.
+	if(n <= MAX_TABLE_N && windows * DENSE_COLLECT_RATIO >= tableSize(n)) {
+		std::vector<count_t> counts(tableSize(n), 0);
+		for(auto it = indices.begin(); it != indices.end(); ++it) {
+			++counts[*it];
+		}
+		addTable(counts.data(), windows);
+		return 0;
+	}
+
+	std::sort(indices.begin(), indices.end());
+	ngram_t ngram(n, 'A');
+	for(auto it = indices.begin(); it != indices.end(); ) {
+		auto run = std::upper_bound(it, indices.end(), *it);
+		indexNgram(*it, n, ngram);
+		freqs[ngram] += run - it;
+		it = run;
+	}
+	totalCount += windows;
+	return 0;
+}
+
+void FrequencyCollector::collectChunk(const char *text, std::size_t size, ngram_t &window,
+		unsigned &filled) {
+	for(const char *end = text + size; text < end; ++text) {
 		//  Only select the letters
-		if(!isalpha(ch)) continue;
-		++totalCount;
+		if(!isalpha(static_cast<unsigned char>(*text))) continue;
 		// 	Make sure it is uppercase
-		queue[curPos++] = toupper(ch);
-		curPos = curPos % n;
-		// 	Reorder the chars starting with curPos and wrapping
-		ngram_t ngram;
-		for(unsigned i = 0; i < n; i++) {
-			ngram.push_back(queue[(curPos + i) % n]);
+		char ch = toupper(static_cast<unsigned char>(*text));
+		if(filled < n) {
+			// 	Fill up the window before adding ngrams to map
+			window[filled++] = ch;
+			if(filled < n) continue;
+		} else {
+			//	Drop the oldest letter
+			window.erase(0, 1);
+			window.push_back(ch);
 		}
 		// 	Count how many times that n-gram occurs
-		freqs[ngram] ++;
+		++totalCount;
+		freqs[window] ++;
 	}
-	delete[] queue;
-	return 0;
+}
+
+FrequencyCollector& FrequencyCollector::operator+=(const FrequencyCollector &other) {
+	if(other.n != n) {
+		throw Exception("Error: Ngram length contradiction");
+	}
+	if(&other == this) {
+		for(auto it = freqs.begin(); it != freqs.end(); ++it) {
+			it->second *= 2;
+		}
+		totalCount *= 2;
+		return *this;
+	}
+
+	freqs.reserve(freqs.size() + other.freqs.size());
+	for(auto it = other.freqs.begin(); it != other.freqs.end(); ++it) {
+		freqs[it->first] += it->second;
+	}
+	totalCount += other.totalCount;
+	return *this;
+}
+
+FrequencyCollector& FrequencyCollector::operator+=(const NgramTable &table) {
+	if(table.getN() != n) {
+		throw Exception("Error: Ngram length contradiction");
+	}
+	addTable(table.getCounts(), table.getCount());
+	return *this;
+}
+
+void FrequencyCollector::addTable(const count_t *counts, count_t count) {
+	const unsigned long size = tableSize(n);
+	//	Walk the n-gram along with the index instead of dividing it out each time
+	ngram_t ngram(n, 'A');
+	for(unsigned long index = 0; index < size; index++) {
+		if(counts[index])
+			freqs[ngram] += counts[index];
+		for(unsigned i = n; i-- > 0; ) {
+			if(++ngram[i] <= 'Z') break;
+			ngram[i] = 'A';
+		}
+	}
+	totalCount += count;
 }
 
 int FrequencyCollector::printNGrams(std::ostream &buffer) {
-    for(auto it = freqs.begin(); it != freqs.end(); ++it) {
-        buffer << it->first << " " << it->second << '\n';
-    }
-    return 0;
+	//	Most common first, ties in alphabetical order, so output does not depend on
+	//	how the counts were collected
+	std::vector<const std::pair<const ngram_t, count_t>*> sorted;
+	sorted.reserve(freqs.size());
+	for(auto it = freqs.begin(); it != freqs.end(); ++it) {
+		sorted.push_back(&*it);
+	}
+	std::sort(sorted.begin(), sorted.end(), [](const std::pair<const ngram_t, count_t> *a,
+			const std::pair<const ngram_t, count_t> *b) {
+		if(a->second != b->second) return a->second > b->second;
+		return a->first < b->first;
+	});
+	for(auto it = sorted.begin(); it != sorted.end(); ++it) {
+		buffer << (*it)->first << " " << (*it)->second << '\n';
+	}
+	return 0;
 }
 
 unsigned FrequencyCollector::getN() const {
@@ -210,6 +513,45 @@ double FrequencyCollector::frequency(ngram_t ngram) const {
 			return 0;
 }
 
+const std::unordered_map<ngram_t, count_t> &FrequencyCollector::getCounts() const {
+	return freqs;
+}
+
+std::vector<double> FrequencyCollector::frequencyTable() const {
+	if(n > MAX_TABLE_N) {
+		throw InvalidParameters("N is too large for a frequency table");
+	}
+	std::vector<double> table(tableSize(n), 0.0);
+	for(auto it = freqs.begin(); it != freqs.end(); ++it) {
+		if(!tableNgram(it->first.data(), n)) continue;
+		table[ngramIndex(it->first.data(), n)] = double(it->second) / totalCount;
+	}
+	return table;
+}
+
+unsigned long FrequencyCollector::tableSize(unsigned n) {
+	unsigned long size = 1;
+	for(unsigned i = 0; i < n; i++) {
+		size *= 26;
+	}
+	return size;
+}
+
+unsigned long FrequencyCollector::ngramIndex(const char *ngram, unsigned n) {
+	unsigned long index = 0;
+	for(unsigned i = 0; i < n; i++) {
+		index = index * 26 + (ngram[i] - 'A');
+	}
+	return index;
+}
+
+bool FrequencyCollector::tableNgram(const char *ngram, unsigned n) {
+	for(unsigned i = 0; i < n; i++) {
+		if(ngram[i] < 'A' || ngram[i] > 'Z') return false;
+	}
+	return true;
+}
+
 bool FrequencyCollector::isEmpty() const {
 	if(freqs.empty()) return true;
 	return false;
@@ -220,21 +562,3 @@ int FrequencyCollector::clear() {
 	freqs.clear();
 	return 0;
 }
-
-
-unsigned long FrequencyCollector::numFileLines(const char* fileName) {
-	unsigned long numLines = 0;
-	std::ifstream fileReader(fileName);
-	if(fileReader.fail()) {
-		string e = "Failed to open: ";
-		e += fileName;
-		throw std::ios_base::failure(e.c_str());
-	}
-	
-	std::string buffer;
-	while(!fileReader.eof()) {
-		std::getline(fileReader, buffer);
-		++ numLines;
-	}
-	return numLines;
-}
\ No newline at end of file
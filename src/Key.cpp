@@ -13,6 +13,7 @@
  */
 
 #include "Key.hpp"
+#include <algorithm>
 #include <vector>
 #include <stdexcept>
 
@@ -20,7 +21,7 @@ Key::Key(char doubleFill, char extraFill, char omitLetter, char replaceLetter) :
 	Key("", doubleFill, extraFill, omitLetter, replaceLetter) { }
 	
 Key::Key(std::string keyWord, char doubleFill, char extraFill, char omitLetter, char replaceLetter) :
-	keyword{keyWord}, key {}, letterPlace{25} {
+	keyword{keyWord}, key {}, letterRow {}, letterColumn {}, digramTable {} {
 
 	if(isalpha(doubleFill))
 		bufferDouble = toupper(doubleFill);
@@ -53,9 +54,14 @@ std::string Key::getKeyword() {
 	return keyword;
 }
 
-std::vector<char> Key::encrypt(const std::vector<char> &plainText) {
+std::vector<char> Key::encrypt(const std::vector<char> &plainText) const {
 	std::vector<char> cipherText;
-	cipherText.reserve(plainText.size());
+	return encrypt(plainText, cipherText);
+}
+
+std::vector<char> &Key::encrypt(const std::vector<char> &plainText, std::vector<char> &cipherText) const {
+	cipherText.clear();
+	cipherText.reserve(plainText.size() + 1);
 	// Iterate plainText 2 char at a time. Decrypt digram and add to cipherText
 	for(std::vector<char>::const_iterator it = plainText.begin(); it != plainText.end(); ) {
 		char a(*it), b;
@@ -84,10 +90,9 @@ std::vector<char> Key::encrypt(const std::vector<char> &plainText) {
 			}
 		}
 
-		char* newDigram = encryptDigram(a, b);
-		cipherText.push_back(newDigram[0]);
-		cipherText.push_back(newDigram[1]);
-		delete[] newDigram;
+		digram_t newDigram = encryptDigram(a, b);
+		cipherText.push_back(newDigram.first);
+		cipherText.push_back(newDigram.second);
 
 		if(it == plainText.end()) {
 			break;
@@ -98,32 +103,134 @@ std::vector<char> Key::encrypt(const std::vector<char> &plainText) {
 	return cipherText;
 }
 
-std::vector<char> Key::decrypt(const std::vector<char> &cipherText) {
+std::vector<char> Key::decrypt(const std::vector<char> &cipherText) const {
 	std::vector<char> plainText;
-	plainText.reserve(cipherText.size());
+	return decrypt(cipherText, plainText);
+}
+
+std::vector<char> &Key::decrypt(const std::vector<char> &cipherText, std::vector<char> &plainText) const {
+	// An odd length cipherText gets a buffer letter added to the end
+	std::size_t length = cipherText.size();
+	plainText.resize(length + (length % 2));
 	// Iterate cipherText 2 char at a time. Decrypt digram and add to plainText
-	for(std::vector<char>::const_iterator it = cipherText.begin(); it != cipherText.end(); ) {
-		char a(*it), b;
-		if(++it == cipherText.end()) {
+	for(std::size_t index = 0; index < length; index += 2) {
+		char a = cipherText[index], b;
+		if(index + 1 == length) {
 			// Add buffer to the end of odd length message.
 			// Though if this class' encrypt() was used, this will never be the case.
 			b = bufferExtra;
 		}
-		else b = *it;
-
-		char* newDigram = decryptDigram(a, b);
-		plainText.push_back(newDigram[0]);
-		plainText.push_back(newDigram[1]);
-		delete[] newDigram;
-		
-		if(it == cipherText.end()) {
-			break;
-		}
-		else ++it;
+		else b = cipherText[index + 1];
+
+		digram_t newDigram;
+		if(digramTable.empty())
+			newDigram = decryptDigram(a, b);
+		else
+			newDigram = digramTable[25 * getPlace(a) + getPlace(b)];
+		plainText[index] = newDigram.first;
+		plainText[index + 1] = newDigram.second;
 	}
 	return plainText;
 }
 
+int Key::swapLetters(char a, char b) {
+	int aPlace = getPlace(a);
+	int bPlace = getPlace(b);
+	key[aPlace] = b;
+	key[bPlace] = a;
+	std::swap(letterRow[a - 'A'], letterRow[b - 'A']);
+	std::swap(letterColumn[a - 'A'], letterColumn[b - 'A']);
+	digramTable.clear();
+	return 0;
+}
+
+std::vector<std::size_t> &Key::decryptSwap(const std::vector<char> &cipherText,
+		std::vector<char> &plainText, char a, char b, std::vector<std::size_t> &changed) {
+	swapLetters(a, b);
+	changed.clear();
+	//	Maps each letter to itself, except a and b which are exchanged
+	char swapped[26];
+	for(int i = 0; i < 26; i ++) {
+		swapped[i] = 'A' + i;
+	}
+	swapped[a - 'A'] = b;
+	swapped[b - 'A'] = a;
+	std::size_t length = cipherText.size();
+	for(std::size_t index = 0; index < length; index += 2) {
+		char c1 = cipherText[index];
+		char c2 = (index + 1 == length) ? bufferExtra : cipherText[index + 1];
+		char p1 = plainText[index];
+		char p2 = plainText[index + 1];
+
+		digram_t newDigram;
+		if(c1 == a || c1 == b || c2 == a || c2 == b) {
+			newDigram = decryptDigram(c1, c2);
+		} else {
+			// The cipher letters kept their places, so the plain letters come from
+			// the same places as before. Only a and b have moved between them.
+			newDigram.first = swapped[p1 - 'A'];
+			newDigram.second = swapped[p2 - 'A'];
+		}
+		if(newDigram.first != p1 || newDigram.second != p2) {
+			plainText[index] = newDigram.first;
+			plainText[index + 1] = newDigram.second;
+			changed.push_back(index);
+		}
+	}
+	return changed;
+}
+
+std::string Key::getSquare() const {
+	return std::string(key, key + 25);
+}
+
+std::string Key::canonicalSquare(const std::string &square) {
+	if(square.size() != 25)
+		throw std::invalid_argument("A square has 25 letters");
+	int first = std::distance(square.begin(), std::min_element(square.begin(), square.end()));
+	int row = first / 5;
+	int column = first % 5;
+	std::string canonical(25, ' ');
+	for(int r = 0; r < 5; r++) {
+		for(int c = 0; c < 5; c++) {
+			canonical[5 * r + c] = square[5 * ((r + row) % 5) + (c + column) % 5];
+		}
+	}
+	return canonical;
+}
+
+std::string Key::canonicalKey(const std::string &key) {
+	//	A full square has 25 different uppercase letters, none of them LOMIT
+	bool square = key.size() == 25;
+	unsigned seen = 1 << (LOMIT - 'A');
+	for(std::size_t i = 0; square && i < key.size(); i++) {
+		if(key[i] < 'A' || key[i] > 'Z')
+			square = false;
+		else {
+			unsigned letter = 1u << (key[i] - 'A');
+			square = !(seen & letter);
+			seen |= letter;
+		}
+	}
+	if(square)
+		return canonicalSquare(key);
+	return canonicalSquare(Key(key).getSquare());
+}
+
+int Key::buildDigramTable() {
+	digramTable.resize(25 * 25);
+	for(int a = 0; a < 25; a++) {
+		for(int b = 0; b < 25; b++) {
+			digramTable[25 * a + b] = decryptDigram(key[a], key[b]);
+		}
+	}
+	return 0;
+}
+
+bool Key::hasDigramTable() const {
+	return !digramTable.empty();
+}
+
 std::vector<char>& Key::sanitizeText(std::vector<char> &text) {
 	for (std::vector<char>::iterator it = text.begin() ; it != text.end();) {
 		// Change uppercase letters to lowercase
@@ -148,6 +255,10 @@ std::vector<char>& Key::sanitizeText(std::vector<char> &text) {
 int Key::generate() {
 	std::vector<char> keywordV(keyword.begin(), keyword.end());
 	sanitizeText(keywordV);
+	for(int i = 0; i < 26; i ++) {
+		letterRow[i] = -1;
+		letterColumn[i] = -1;
+	}
 	
 	// The letter's place on the square is held as a number 0-24
 	int lettersUsed = 0;
@@ -155,9 +266,10 @@ int Key::generate() {
     for(int index = 0; index < int(keywordV.size()); index ++) {
     	char letter = keywordV.at(index);
     	// No duplicate letters in square!
-    	if(letterPlace.find(letter) == letterPlace.end()) {
-	    	letterPlace[letter] = lettersUsed;
-	    	key[getRow(lettersUsed)][getColumn(lettersUsed)] = letter;
+    	if(letterRow[letter - 'A'] < 0) {
+	    	letterRow[letter - 'A'] = getRow(lettersUsed);
+	    	letterColumn[letter - 'A'] = getColumn(lettersUsed);
+	    	key[lettersUsed] = letter;
 	    	lettersUsed ++;
 	    }
     }
@@ -167,63 +279,63 @@ int Key::generate() {
     	if(i == letterOmit) continue;
     	char letter(i);
     	// No duplicate letters in square!
-    	if(letterPlace.find(letter) == letterPlace.end()) {
-    		letterPlace[letter] = lettersUsed;
-    		key[getRow(lettersUsed)][getColumn(lettersUsed)] = letter;
+    	if(letterRow[letter - 'A'] < 0) {
+	    	letterRow[letter - 'A'] = getRow(lettersUsed);
+	    	letterColumn[letter - 'A'] = getColumn(lettersUsed);
+    		key[lettersUsed] = letter;
     		lettersUsed ++;
     	}
     }
     return 0;
 }
 
-char* Key::encryptDigram(char a, char b) {
-	char *digram = new char[2]();
-	int aPos = letterPlace.at(a);
-	int bPos = letterPlace.at(b);
-	int aRow = getRow(aPos);
-	int aCol = getColumn(aPos);
-	int bRow = getRow(bPos);
-	int bCol = getColumn(bPos);
+digram_t Key::encryptDigram(char a, char b) const {
+	digram_t digram;
+	int aRow = letterRow[a - 'A'];
+	int aCol = letterColumn[a - 'A'];
+	int bRow = letterRow[b - 'A'];
+	int bCol = letterColumn[b - 'A'];
 
 	if(aRow == bRow) {
-		digram[0] = key[aRow][(aCol + 1) % 5];
-		digram[1] = key[bRow][(bCol + 1) % 5];
+		digram.first = key[5 * aRow + (aCol + 1) % 5];
+		digram.second = key[5 * bRow + (bCol + 1) % 5];
 	} else if(aCol == bCol) {
-		digram[0] = key[(aRow + 1) % 5][aCol];
-		digram[1] = key[(bRow + 1) % 5][bCol];
+		digram.first = key[5 * ((aRow + 1) % 5) + aCol];
+		digram.second = key[5 * ((bRow + 1) % 5) + bCol];
 	} else {
-		digram[0] = key[aRow][bCol];
-		digram[1] = key[bRow][aCol];
+		digram.first = key[5 * aRow + bCol];
+		digram.second = key[5 * bRow + aCol];
 	}
 	return digram;
 }
 
-char *Key::decryptDigram(char a, char b){
-	char *digram = new char[2]();
-	int aPos = letterPlace.at(a);
-	int bPos = letterPlace.at(b);
-	int aRow = getRow(aPos);
-	int aCol = getColumn(aPos);
-	int bRow = getRow(bPos);
-	int bCol = getColumn(bPos);
+digram_t Key::decryptDigram(char a, char b) const {
+	digram_t digram;
+	int aRow = letterRow[a - 'A'];
+	int aCol = letterColumn[a - 'A'];
+	int bRow = letterRow[b - 'A'];
+	int bCol = letterColumn[b - 'A'];
 
 	if(aRow == bRow) {
-		digram[0] = key[aRow][(aCol + 4) % 5];
-		digram[1] = key[bRow][(bCol + 4) % 5];
+		digram.first = key[5 * aRow + (aCol + 4) % 5];
+		digram.second = key[5 * bRow + (bCol + 4) % 5];
 	} else if(aCol == bCol) {
-		digram[0] = key[(aRow + 4) % 5][aCol];
-		digram[1] = key[(bRow + 4) % 5][bCol];
+		digram.first = key[5 * ((aRow + 4) % 5) + aCol];
+		digram.second = key[5 * ((bRow + 4) % 5) + bCol];
 	} else {
-		digram[0] = key[aRow][bCol];
-		digram[1] = key[bRow][aCol];
+		digram.first = key[5 * aRow + bCol];
+		digram.second = key[5 * bRow + aCol];
 	}
 	return digram;
 }
 
-int Key::getRow(int place) {
+int Key::getPlace(char letter) const {
+	return 5 * letterRow[letter - 'A'] + letterColumn[letter - 'A'];
+}
+int Key::getRow(int place) const {
 	return (place / 5);
 }
-int Key::getColumn(int place) {
+int Key::getColumn(int place) const {
 	return (place % 5);
 }
 
@@ -0,0 +1,95 @@
+/* PlayfairCracker - Crack Playfair Encryptions
+ * Copyright (C) 2018 Yesha Maggi
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#include "KeyBatch.hpp"
+#include <algorithm>
+
+using std::vector;
+using std::string;
+
+namespace {
+	///	The row or column before each of the 5 rows or columns, wrapping around
+	const int previous[5] = {4, 0, 1, 2, 3};
+}
+
+KeyBatch::KeyBatch(const vector<string> &keys, char extraFill)
+		: count(keys.size()), letterRow(26 * keys.size(), -1),
+		letterColumn(26 * keys.size(), -1), square(25 * keys.size()),
+		bufferExtra(extraFill) {
+	for(std::size_t k = 0; k < count; k++) {
+		string keySquare = Key(keys[k], LFILL, extraFill).getSquare();
+		for(int place = 0; place < 25; place++) {
+			int letter = keySquare[place] - 'A';
+			letterRow[letter * count + k] = place / 5;
+			letterColumn[letter * count + k] = place % 5;
+			square[place * count + k] = keySquare[place];
+		}
+	}
+}
+
+KeyBatch::~KeyBatch() {}
+
+vector<vector<char>> &KeyBatch::decrypt(const vector<char> &cipherText,
+		vector<vector<char>> &plainTexts) const {
+	// An odd length cipherText gets a buffer letter added to the end
+	std::size_t length = cipherText.size();
+	plainTexts.resize(count);
+	if(count == 0)
+		return plainTexts;
+	for(std::size_t k = 0; k < count; k++) {
+		plainTexts[k].resize(length + (length % 2));
+	}
+
+	vector<char *> plain(count);
+	for(std::size_t k = 0; k < count; k++) {
+		plain[k] = plainTexts[k].data();
+	}
+
+	//	Keys are taken a block at a time, so that the lookups and the plainTexts
+	//	being written for one block stay in cache while it walks the cipherText
+	for(std::size_t first = 0; first < count; first += KEY_BATCH_BLOCK) {
+		std::size_t last = std::min(first + KEY_BATCH_BLOCK, count);
+		for(std::size_t index = 0; index < length; index += 2) {
+			char a = cipherText[index];
+			char b = index + 1 == length ? bufferExtra : cipherText[index + 1];
+			const signed char *aRows = &letterRow[(a - 'A') * count];
+			const signed char *aCols = &letterColumn[(a - 'A') * count];
+			const signed char *bRows = &letterRow[(b - 'A') * count];
+			const signed char *bCols = &letterColumn[(b - 'A') * count];
+
+			// Same rules as Key::decryptDigram(), chosen by selects rather than
+			//	branches as each key in the batch may take a different one
+			for(std::size_t k = first; k < last; k++) {
+				int aRow = aRows[k], aCol = aCols[k];
+				int bRow = bRows[k], bCol = bCols[k];
+				bool sameRow = aRow == bRow;
+				bool sameCol = !sameRow && aCol == bCol;
+
+				int firstRow = sameCol ? previous[aRow] : aRow;
+				int secondRow = sameCol ? previous[bRow] : bRow;
+				int firstCol = sameRow ? previous[aCol] : (sameCol ? aCol : bCol);
+				int secondCol = sameRow ? previous[bCol] : (sameCol ? bCol : aCol);
+
+				plain[k][index] = square[(5 * firstRow + firstCol) * count + k];
+				plain[k][index + 1] = square[(5 * secondRow + secondCol) * count + k];
+			}
+		}
+	}
+	return plainTexts;
+}
+
+std::size_t KeyBatch::size() const {
+	return count;
+}
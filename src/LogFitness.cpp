@@ -0,0 +1,90 @@
+/* PlayfairCracker - Crack Playfair Encryptions
+ * Copyright (C) 2018 Yesha Maggi
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "LogFitness.hpp"
+#include "PfHelpers.hpp"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+LogFitness::LogFitness(const FrequencyCollector &standardFreq):
+	logTable{}, floor{0}, n{standardFreq.getN()},
+	sumWindows{NgramKernel::sumKernel(standardFreq.getN())} {
+		if(standardFreq.isEmpty()) {
+			throw Exception("Error: A frequency map is empty");
+		}
+		buildTable(standardFreq.frequencyTable(), standardFreq.getCount());
+	}
+
+LogFitness::LogFitness(const NgramTable &standardTable):
+	logTable{}, floor{0}, n{standardTable.getN()},
+	sumWindows{NgramKernel::sumKernel(standardTable.getN())} {
+		if(!standardTable.getCount()) {
+			throw Exception("Error: A frequency map is empty");
+		}
+		buildTable(standardTable.frequencyTable(), standardTable.getCount());
+	}
+LogFitness::~LogFitness() {}
+
+score_t LogFitness::score(const std::vector<char> &text) const {
+	//	0 would beat the score of every real text
+	if(text.size() < n) {
+		throw Exception("Error: Text is shorter than n");
+	}
+	return sumWindows(logTable.data(), text.data(), text.size() - n + 1);
+}
+
+score_t LogFitness::rescore(const std::vector<char> &oldText, score_t oldScore,
+		const std::vector<char> &newText, const std::vector<std::size_t> &changed) const {
+	if(newText.size() < n) {
+		throw Exception("Error: Text is shorter than n");
+	}
+
+	const std::size_t lastStart = newText.size() - n;
+	score_t score = oldScore;
+	auto it = changed.begin();
+	while(it != changed.end()) {
+		//  Windows starting in [first, last] overlap the digram at *it. Merge the
+		//  ranges of following digrams that overlap or touch this one.
+		std::size_t first = (*it + 1 >= n) ? *it + 1 - n : 0;
+		std::size_t last = std::min(*it + 1, lastStart);
+		for(++it; it != changed.end() && *it + 1 <= last + n; ++it) {
+			last = std::min(*it + 1, lastStart);
+		}
+		if(first > last) continue;
+
+		score += sumWindows(logTable.data(), newText.data() + first, last - first + 1) -
+			sumWindows(logTable.data(), oldText.data() + first, last - first + 1);
+	}
+	return score;
+}
+
+unsigned LogFitness::getN() const {
+	return n;
+}
+
+score_t LogFitness::getFloor() const {
+	return floor;
+}
+
+void LogFitness::buildTable(std::vector<double> frequencies, count_t count) {
+	floor = std::log10(0.01 / count);
+	logTable = std::move(frequencies);
+	for(unsigned long index = 0; index < logTable.size(); index++) {
+		if(logTable[index] > 0)
+			logTable[index] = std::log10(logTable[index]);
+		else
+			logTable[index] = floor;
+	}
+}
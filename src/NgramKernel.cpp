@@ -0,0 +1,103 @@
+/* PlayfairCracker - Crack Playfair Encryptions
+ * Copyright (C) 2018 Yesha Maggi
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#include "NgramKernel.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define NGRAM_KERNEL_AVX2
+#endif
+
+namespace {
+#ifdef NGRAM_KERNEL_AVX2
+	/**
+	 * sumWindows() on 8 windows at a time. The indices of 8 windows are built from 8
+	 * 	letters each for every position in the n-gram, then their table entries are
+	 * 	gathered 4 at a time. Window pos lands in lane pos % 4, so the lanes are the
+	 * 	partial sums of sumWindows() and finishSum() completes them the same way.
+	 */
+	template <unsigned N>
+	__attribute__((target("avx2")))
+	score_t sumWindowsAvx2(const score_t *table, const char *text, std::size_t windows) {
+		const __m256i offset = _mm256_set1_epi32('A');
+		const __m256i radix = _mm256_set1_epi32(26);
+		//	The masked gather with a zero source avoids GCC warning about the
+		//	uninitialized source of _mm256_i32gather_pd
+		const __m256d zero = _mm256_setzero_pd();
+		const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+		__m256d sums = _mm256_setzero_pd();
+		std::size_t pos = 0;
+		for(; pos + 8 <= windows; pos += 8) {
+			__m256i index = _mm256_setzero_si256();
+			for(unsigned i = 0; i < N; i++) {
+				//	Letter i of windows pos to pos + 7
+				__m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(text + pos + i));
+				__m256i letters = _mm256_sub_epi32(_mm256_cvtepu8_epi32(bytes), offset);
+				index = _mm256_add_epi32(_mm256_mullo_epi32(index, radix), letters);
+			}
+			sums = _mm256_add_pd(sums, _mm256_mask_i32gather_pd(zero, table,
+				_mm256_castsi256_si128(index), all, 8));
+			sums = _mm256_add_pd(sums, _mm256_mask_i32gather_pd(zero, table,
+				_mm256_extracti128_si256(index, 1), all, 8));
+		}
+		score_t lanes[NgramKernel::SUM_LANES];
+		_mm256_storeu_pd(lanes, sums);
+		return NgramKernel::finishSum<N>(table, text, windows, pos, lanes);
+	}
+#endif
+}
+
+NgramKernel::IndexKernel NgramKernel::indexKernel(unsigned n) {
+	switch(n) {
+		case 1: return windowIndices<1>;
+		case 2: return windowIndices<2>;
+		case 3: return windowIndices<3>;
+		case 4: return windowIndices<4>;
+		case 5: return windowIndices<5>;
+		default: return nullptr;
+	}
+}
+
+NgramKernel::SumKernel NgramKernel::sumKernel(unsigned n, bool simd) {
+#ifdef NGRAM_KERNEL_AVX2
+	if(simd && hasSimd()) {
+		switch(n) {
+			case 1: return sumWindowsAvx2<1>;
+			case 2: return sumWindowsAvx2<2>;
+			case 3: return sumWindowsAvx2<3>;
+			case 4: return sumWindowsAvx2<4>;
+			case 5: return sumWindowsAvx2<5>;
+			default: return nullptr;
+		}
+	}
+#endif
+	switch(n) {
+		case 1: return sumWindows<1>;
+		case 2: return sumWindows<2>;
+		case 3: return sumWindows<3>;
+		case 4: return sumWindows<4>;
+		case 5: return sumWindows<5>;
+		default: return nullptr;
+	}
+}
+
+bool NgramKernel::hasSimd() {
+#ifdef NGRAM_KERNEL_AVX2
+	static const bool avx2 = __builtin_cpu_supports("avx2");
+	return avx2;
+#else
+	return false;
+#endif
+}
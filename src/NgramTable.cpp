@@ -0,0 +1,74 @@
+/* PlayfairCracker - Crack Playfair Encryptions
+ * Copyright (C) 2018 Yesha Maggi
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#include "NgramTable.hpp"
+#include "PfHelpers.hpp"
+#include <fstream>
+#include <string.h>
+
+static_assert(sizeof(count_t) == sizeof(std::uint64_t), "Table counts must be 64 bits");
+static_assert(sizeof(NgramTableHeader) == 24, "Table header must not be padded");
+
+NgramTable::NgramTable(const char* fileName) :
+	file{fileName}, header{nullptr}, counts{nullptr} {
+		if(file.size() < sizeof(NgramTableHeader) ||
+				memcmp(file.data(), NGRAM_TABLE_MAGIC, NGRAM_TABLE_MAGIC_SIZE) != 0) {
+			throw Exception("Error: Not an n-gram table file");
+		}
+		header = reinterpret_cast<const NgramTableHeader*>(file.data());
+		if(header->n < 1 || header->n > MAX_TABLE_N || header->alphabet != 26) {
+			throw Exception("Error: Unsupported n-gram table");
+		}
+		if(file.size() != sizeof(NgramTableHeader) + size() * sizeof(count_t)) {
+			throw Exception("Error: N-gram table file is truncated");
+		}
+		//	mmap is page aligned and the header is 24 bytes, so the counts are aligned
+		counts = reinterpret_cast<const count_t*>(file.data() + sizeof(NgramTableHeader));
+	}
+
+NgramTable::~NgramTable() {}
+
+unsigned NgramTable::getN() const {
+	return header->n;
+}
+
+count_t NgramTable::getCount() const {
+	return header->totalCount;
+}
+
+unsigned long NgramTable::size() const {
+	return FrequencyCollector::tableSize(header->n);
+}
+
+const count_t *NgramTable::getCounts() const {
+	return counts;
+}
+
+std::vector<double> NgramTable::frequencyTable() const {
+	std::vector<double> table(size(), 0.0);
+	if(!header->totalCount) return table;
+	const double total = header->totalCount;
+	for(unsigned long index = 0; index < table.size(); index++) {
+		table[index] = counts[index] / total;
+	}
+	return table;
+}
+
+bool NgramTable::isTableFile(const char* fileName) {
+	std::ifstream fileReader(fileName, std::ifstream::binary);
+	char magic[NGRAM_TABLE_MAGIC_SIZE];
+	if(!fileReader.read(magic, NGRAM_TABLE_MAGIC_SIZE)) return false;
+	return memcmp(magic, NGRAM_TABLE_MAGIC, NGRAM_TABLE_MAGIC_SIZE) == 0;
+}
@@ -0,0 +1,177 @@
+/* PlayfairCracker - Crack Playfair Encryptions
+ * Copyright (C) 2018 Yesha Maggi
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#include "ParentSelection.hpp"
+#include "PfHelpers.hpp"
+#include <algorithm>
+#include <random>
+
+using ParentSelection::RouletteWheel;
+
+RouletteWheel::RouletteWheel(const vector<score_t> &scores) {
+	if(scores.size() < 2)
+		throw InvalidParameters("Parent selection needs at least 2 members");
+	score_t worst = *std::min_element(scores.begin(), scores.end());
+	runningSum.resize(scores.size());
+	score_t sum = 0;
+	for(unsigned index = 0; index < scores.size(); index++) {
+		sum += scores[index] - worst;
+		runningSum[index] = sum;
+	}
+}
+
+RouletteWheel::~RouletteWheel() {}
+
+unsigned RouletteWheel::spin(rng_t &rng) const {
+	score_t sum = runningSum.back();
+	if(sum <= 0) {
+		std::uniform_int_distribution<unsigned> uid(0, runningSum.size() - 1);
+		return uid(rng);
+	}
+	std::uniform_real_distribution<score_t> uid(0, sum);
+	return find(sum - uid(rng));
+}
+
+unsigned RouletteWheel::spin(rng_t &rng, unsigned exclude) const {
+	score_t excluded = share(exclude);
+	score_t sum = runningSum.back() - excluded;
+	if(sum <= 0) {
+		std::uniform_int_distribution<unsigned> uid(0, runningSum.size() - 2);
+		unsigned pick = uid(rng);
+		return pick >= exclude ? pick + 1 : pick;
+	}
+	std::uniform_real_distribution<score_t> uid(0, sum);
+	score_t target = sum - uid(rng);
+	//	Members after exclude have its share in their running sums
+	unsigned pick;
+	if((exclude > 0 && runningSum[exclude - 1] >= target) || exclude + 1 == runningSum.size())
+		pick = find(target);
+	else
+		pick = find(target + excluded, exclude + 1);
+	//	Only rounding can land on exclude, so take a neighbour
+	if(pick == exclude)
+		pick = exclude + 1 < runningSum.size() ? exclude + 1 : exclude - 1;
+	return pick;
+}
+
+vector<unsigned>& RouletteWheel::sample(unsigned count, rng_t &rng, vector<unsigned> &picked) const {
+	picked.clear();
+	picked.reserve(count);
+	score_t sum = runningSum.back();
+	if(count == 0)
+		return picked;
+	if(sum <= 0) {
+		std::uniform_int_distribution<unsigned> uid(0, runningSum.size() - 1);
+		for(unsigned i = 0; i < count; i++) {
+			picked.push_back(uid(rng));
+		}
+		std::sort(picked.begin(), picked.end());
+		return picked;
+	}
+	score_t step = sum / count;
+	std::uniform_real_distribution<score_t> uid(0, step);
+	score_t offset = uid(rng);
+	//	The pointers only move forward, so each search starts at the last pick
+	auto it = runningSum.begin();
+	for(unsigned i = 0; i < count; i++) {
+		it = std::upper_bound(it, runningSum.end(), offset + i * step);
+		if(it == runningSum.end())
+			--it;
+		picked.push_back(std::distance(runningSum.begin(), it));
+	}
+	return picked;
+}
+
+score_t RouletteWheel::share(unsigned index) const {
+	return index ? runningSum[index] - runningSum[index - 1] : runningSum[0];
+}
+
+unsigned RouletteWheel::find(score_t target, unsigned first) const {
+	vector<score_t>::const_iterator it;
+	if(target > 0) {
+		it = std::lower_bound(runningSum.begin() + first, runningSum.end(), target);
+	} else {
+		//	The first member from first on that has a share at all
+		score_t before = first ? runningSum[first - 1] : 0;
+		it = std::upper_bound(runningSum.begin() + first, runningSum.end(), before);
+	}
+	if(it == runningSum.end())
+		--it;
+	return std::distance(runningSum.begin(), it);
+}
+
+unsigned ParentSelection::tournament(const vector<score_t> &scores, unsigned size, rng_t &rng,
+		int exclude) {
+	unsigned candidates = exclude >= 0 ? scores.size() - 1 : scores.size();
+	if(candidates == 0)
+		throw InvalidParameters("Parent selection needs at least 2 members");
+	std::uniform_int_distribution<unsigned> uid(0, candidates - 1);
+	unsigned best = 0;
+	for(unsigned round = 0; round < std::max(size, 1u); round++) {
+		unsigned pick = uid(rng);
+		if(exclude >= 0 && pick >= unsigned(exclude))
+			++pick;
+		if(round == 0 || scores[pick] > scores[best])
+			best = pick;
+	}
+	return best;
+}
+
+vector<parents_t>& ParentSelection::selectParents(const vector<score_t> &scores,
+		const GenParams &genParams, rng_t &rng, vector<parents_t> &pairs) {
+	if(scores.size() < 2)
+		throw InvalidParameters("Parent selection needs at least 2 members");
+	unsigned count = std::max(genParams.parentPairs, 1u);
+	pairs.clear();
+	pairs.reserve(count);
+	switch(genParams.selection) {
+		case ROULETTE: {
+			RouletteWheel wheel(scores);
+			for(unsigned pair = 0; pair < count; pair++) {
+				unsigned first = wheel.spin(rng);
+				pairs.emplace_back(first, wheel.spin(rng, first));
+			}
+			break;
+		}
+		case SUS: {
+			RouletteWheel wheel(scores);
+			vector<unsigned> picked;
+			wheel.sample(2 * count, rng, picked);
+			std::shuffle(picked.begin(), picked.end(), rng);
+			for(unsigned pair = 0; pair < count; pair++) {
+				unsigned first = picked[2 * pair];
+				unsigned second = picked[2 * pair + 1];
+				//	A member picked twice cannot pair with itself
+				if(second == first)
+					second = wheel.spin(rng, first);
+				pairs.emplace_back(first, second);
+			}
+			break;
+		}
+		case TOURNAMENT: {
+			unsigned size = genParams.tournamentSize ? genParams.tournamentSize : 2;
+			for(unsigned pair = 0; pair < count; pair++) {
+				unsigned first = tournament(scores, size, rng);
+				pairs.emplace_back(first, tournament(scores, size, rng, first));
+			}
+			break;
+		}
+		default: {
+			std::cerr << "Invalid selection: " << genParams.selection << '\n';
+			throw InvalidParameters("Invalid Parameters: selection");
+		}
+	}
+	return pairs;
+}
@@ -21,6 +21,10 @@
 #include <string.h>
 #include <unordered_map>
 #include <stdlib.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using std::vector;
 using std::string;
@@ -134,5 +138,46 @@ namespace PfHelpers {
 	double Timer::elapsed() const {
 		return std::chrono::duration_cast<second_t>(clock_t::now() - m_beg).count();
 	}
-	
-}
\ No newline at end of file
+
+	MappedFile::MappedFile(const char* fileName) : m_data{nullptr}, m_size{0} {
+		int fd = open(fileName, O_RDONLY);
+		if(fd < 0) {
+			string e = "Failed to open: ";
+			e += fileName;
+			throw std::ios_base::failure(e.c_str());
+		}
+		struct stat info;
+		if(fstat(fd, &info) != 0) {
+			close(fd);
+			string e = "Failed to read: ";
+			e += fileName;
+			throw std::ios_base::failure(e.c_str());
+		}
+		m_size = info.st_size;
+		if(m_size > 0) {
+			void *map = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if(map == MAP_FAILED) {
+				close(fd);
+				string e = "Failed to map: ";
+				e += fileName;
+				throw std::ios_base::failure(e.c_str());
+			}
+			m_data = static_cast<const char*>(map);
+		}
+		//	The mapping stays valid after the descriptor is closed
+		close(fd);
+	}
+
+	MappedFile::~MappedFile() {
+		if(m_data)
+			munmap(const_cast<char*>(m_data), m_size);
+	}
+
+	const char* MappedFile::data() const {
+		return m_data;
+	}
+
+	std::size_t MappedFile::size() const {
+		return m_size;
+	}
+}
@@ -14,18 +14,29 @@
 
 #include "FrequencyCollector.hpp"
 #include "Key.hpp"
+#include "KeyBatch.hpp"
+#include "ParentSelection.hpp"
 #include "PlayfairGenetic.hpp"
 #include "PfHelpers.hpp"
+#include "ScoreCache.hpp"
 #include <algorithm>
-#include <sstream>
+#include <exception>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <unordered_set>
 
 #define ALPHABET "ABCDEFGHIKLMNOPQRSTUVWXYZ"
+/**
+ * How many times a new member is made again, or mutated again, while it is
+ *  equivalent to a member already in the population.
+ */
+#define UNIQUE_TRIES 10
 
 using std::vector;
 using std::unordered_map;
+using std::unordered_set;
 using std::string;
-using std::stringstream;
-using std::list;
 
 namespace {
 	string randomKey(rng_t &rng) {
@@ -63,98 +74,185 @@ namespace {
 		return key;
 	}
 
-	list<string> keepBest(const pop_t &population, const vector<score_t> scores,
-			const GenParams genParams) {
+	//	Orders member indices best first. Equal scores keep population order, as the
+	//	first of several equal members was always the one picked.
+	struct BetterMember {
+		const vector<score_t> &scores;
+		bool operator()(unsigned left, unsigned right) const {
+			if(scores[left] != scores[right])
+				return scores[left] > scores[right];
+			return left < right;
+		}
+	};
+
+	//	Orders member indices worst first, the first of equal members being worst
+	struct WorseMember {
+		const vector<score_t> &scores;
+		bool operator()(unsigned left, unsigned right) const {
+			if(scores[left] != scores[right])
+				return scores[left] < scores[right];
+			return left < right;
+		}
+	};
+
+	//	Returns the keepBest best members, skipping any equivalent to a better one
+	//	(see Key::canonicalKey()). The canonical forms of the kept members are added
+	//	to seen.
+	vector<std::pair<string, score_t>> keepBest(const pop_t &population, const vector<score_t> &scores,
+			const GenParams &genParams, vector<unsigned> &order, unordered_set<string> &seen) {
 		if(population.size() != scores.size()) 
 			throw InvalidParameters("Vector sizes do not match: population & scores");
 
-		list<string> bestPop;
-		list<std::pair<string, score_t>> pop;
-		for(unsigned index = 0; index < scores.size(); index++) {
-			pop.push_back(std::pair<string, score_t> (population.at(index), scores.at(index)));
+		unsigned count = std::min<std::size_t>(genParams.keepBest, population.size());
+		order.resize(population.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::partial_sort(order.begin(), order.begin() + count, order.end(), BetterMember{scores});
+
+		vector<std::pair<string, score_t>> bestPop;
+		bestPop.reserve(count);
+		for(unsigned index = 0; index < order.size() && bestPop.size() < count; index++) {
+			//	Equivalent members were skipped, so the rest are needed in order too
+			if(index == count)
+				std::sort(order.begin() + count, order.end(), BetterMember{scores});
+			if(seen.insert(Key::canonicalKey(population[order[index]])).second)
+				bestPop.emplace_back(population[order[index]], scores[order[index]]);
 		}
-
-
-		for(unsigned index = 0; index < genParams.keepBest; index++) {
-			auto max = std::max_element(pop.begin(), pop.end(),
-	            [](const std::pair<string, score_t>& left, const std::pair<string, score_t>& right){
-		            return left.second <  right.second;
-		        });
-			bestPop.push_back(max->first);
-			pop.erase(max);
-		}	
-
 		return bestPop;
 	}
 
-	vector<score_t> fitnessPopulation(const EnglishFitness &englishFit, const pop_t &population,
-			const vector<char> &cipherText) {
-		unsigned n = englishFit.getN();
-		vector<score_t> scores;
-		FrequencyCollector fCollector(n);
-		for(auto it = population.begin(); it != population.end(); ++it) {
-			fCollector.clear();
-
-			Key key(*it);
-			vector<char> pText = key.decrypt(cipherText);
-			stringstream pTextStream(string(pText.begin(), pText.end()));
-
-			fCollector.collectNGrams(pTextStream);
-			try {
-				scores.push_back(englishFit.fitness(fCollector));
-			} catch(Exception e) {
-				std::cerr << e.what() << '\n';
-				throw;
+	//	Removes the count worst members, keeping the rest in order
+	pop_t& killWorst(pop_t &population, vector<score_t> &scores, unsigned count,
+			vector<unsigned> &order) {
+		count = std::min<std::size_t>(count, population.size());
+		if(count == 0)
+			return population;
+		order.resize(population.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::nth_element(order.begin(), order.begin() + count - 1, order.end(), WorseMember{scores});
+		//	Everything up to the count-th worst goes. Scores are moved below, so the
+		//	score of the count-th worst is copied first.
+		unsigned last = order[count - 1];
+		score_t lastScore = scores[last];
+		unsigned kept = 0;
+		for(unsigned index = 0; index < population.size(); index++) {
+			if(scores[index] > lastScore || (scores[index] == lastScore && index > last)) {
+				if(kept != index) {
+					population[kept] = std::move(population[index]);
+					scores[kept] = scores[index];
+				}
+				++kept;
 			}
 		}
-		return scores;
+		population.resize(kept);
+		scores.resize(kept);
+		return population;
 	}
 
-	std::pair<int, int> selectParents(const vector<score_t> &scores, rng_t &rng) {
-		// 	Update to parent selection. Subtracting lowestFitnessValue from all fitness scores,
-		//		then we use their proportions
-		vector<score_t> cpyScores = scores;
-		score_t worst = cpyScores.at(std::distance(cpyScores.begin(), std::min_element(cpyScores.begin(), cpyScores.end())));
-		for(unsigned index = 0; index < cpyScores.size(); index++) {
-			cpyScores[index] = cpyScores[index] - worst;
+	int scoreMembers(const Fitness &fitness, const pop_t &population, const vector<char> &cipherText,
+			unsigned first, unsigned last, vector<score_t> &scores, ScoreCache *cache) {
+		//	Only members without a cached score are decrypted
+		vector<unsigned> members;
+		vector<string> squares;
+		members.reserve(last - first);
+		for(unsigned index = first; index < last; index++) {
+			if(cache) {
+				string square = Key::canonicalKey(population[index]);
+				if(cache->find(square, scores[index]))
+					continue;
+				squares.push_back(square);
+			}
+			members.push_back(index);
 		}
 
-		score_t scoreSum = PfHelpers::sumVector(cpyScores);
-
-		//  Get a random double in range [0-scoreSum]
-		std::uniform_real_distribution<score_t> uid(0,scoreSum);
-		score_t pSelect = uid(rng);
-		//  Select first parent
-		int selection = -1;
-		while(pSelect < scoreSum) {
-			pSelect += cpyScores.at(++selection);
+		if(cipherText.size() < DIGRAM_TABLE_MIN) {
+			//	Short cipherTexts are decrypted by all keys together, see KeyBatch
+			vector<string> keys;
+			keys.reserve(members.size());
+			for(auto it = members.begin(); it != members.end(); ++it) {
+				keys.push_back(population[*it]);
+			}
+			KeyBatch batch(keys);
+			vector<vector<char>> pTexts;
+			batch.decrypt(cipherText, pTexts);
+			for(unsigned member = 0; member < members.size(); member++) {
+				scores[members[member]] = fitness.score(pTexts[member]);
+			}
+		} else {
+			//	Decrypt every key into the same buffer
+			vector<char> pText;
+			pText.reserve(cipherText.size() + 1);
+			for(auto it = members.begin(); it != members.end(); ++it) {
+				Key key(population[*it]);
+				key.buildDigramTable();
+				key.decrypt(cipherText, pText);
+				scores[*it] = fitness.score(pText);
+			}
 		}
 
-		//  Select second parent
-		scoreSum -= cpyScores.at(selection);
-		int selection2 = 0;
-		std::uniform_real_distribution<score_t> uid2(0,scoreSum);
-		pSelect = uid2(rng);
-		while(pSelect < scoreSum) {
-			//  Don't pick the first parent twice
-			if(selection2 != selection)
-				pSelect += cpyScores.at(selection2);
-			++selection2;
+		if(cache) {
+			for(unsigned member = 0; member < members.size(); member++) {
+				cache->insert(squares[member], scores[members[member]]);
+			}
 		}
-		--selection2;
+		return 0;
+	}
 
-		std::pair<int, int> p(selection, selection2);
-		return p;
+	//	Scores the first count members of population, or all of them if count is
+	//	larger. scores is resized to the population, and the rest are left as they are.
+	vector<score_t> &fitnessPopulation(const Fitness &fitness, const pop_t &population,
+			const vector<char> &cipherText, unsigned threads, vector<score_t> &scores,
+			ScoreCache *cache, unsigned count = -1) {
+		scores.resize(population.size());
+		count = std::min<unsigned>(count, population.size());
+		if(threads > count)
+			threads = count;
+		try {
+			if(threads <= 1) {
+				scoreMembers(fitness, population, cipherText, 0, count, scores, cache);
+				return scores;
+			}
+
+			//	Each thread scores its own contiguous slice of the population into its
+			//	own place in scores, with its own decryption buffer
+			vector<std::thread> workers;
+			vector<std::exception_ptr> errors(threads);
+			unsigned first = 0;
+			for(unsigned t = 0; t < threads; t++) {
+				unsigned last = first + (count - first) / (threads - t);
+				workers.emplace_back([&, first, last, t]() {
+					try {
+						scoreMembers(fitness, population, cipherText, first, last, scores, cache);
+					} catch(...) {
+						errors[t] = std::current_exception();
+					}
+				});
+				first = last;
+			}
+			for(auto it = workers.begin(); it != workers.end(); ++it) {
+				it->join();
+			}
+			for(auto it = errors.begin(); it != errors.end(); ++it) {
+				if(*it) std::rethrow_exception(*it);
+			}
+		} catch(Exception e) {
+			std::cerr << e.what() << '\n';
+			throw;
+		}
+		return scores;
 	}
 
-	pop_t& crossover(pop_t &population, const GenParams &genParams, rng_t &rng) {
-		string p1 = population.at(0);
-		string p2 = population.at(1);
+	//	parents holds the parent pairs, each followed by the other parent. The
+	//	children are shared out between the pairs in turn and added to population.
+	pop_t& crossover(const pop_t &parents, pop_t &population, const GenParams &genParams,
+			rng_t &rng) {
+		unsigned pairs = parents.size() / 2;
 		std::uniform_int_distribution<int> uid(0, 1);
 		//	Child becomes a copy of p1
 		//	Go through every letter and 50% chance to keep it or not
 		//	Letters that aren't being used are added in order from p2
 		for(unsigned i = 0; i < genParams.numChildren; i++) {
+			const string &p1 = parents[2 * (i % pairs)];
+			const string &p2 = parents[2 * (i % pairs) + 1];
 			// 	If a letter exists in this map, it is being used
 			unordered_map<char, bool> letterUsed;
 			string key(p1.begin(), p1.end());
@@ -221,39 +319,60 @@ namespace {
 		return key;
 	}
 
+	string& mutateKey(string &key, const GenParams &genParams, rng_t &rng) {
+		switch(genParams.mutationType) {
+			case SWAP: {
+				swapMutation(key, genParams, rng);
+				break;
+			}
+			case INVERSION: {
+				inversionMutation(key, genParams, rng);					
+				break;
+			}
+			default: {
+				std::cerr << "Invalid mutationType: " << genParams.mutationType << '\n';
+				throw InvalidParameters("Invalid Parameters: mutationType");
+			}
+		}
+		return key;
+	}
+
 	pop_t mutation(pop_t &population, const GenParams &genParams, rng_t &rng) {
 		unsigned index = 0;
 		while(index < population.size()) {
 			string key = population[index];
-
-			switch(genParams.mutationType) {
-				case SWAP: {
-					swapMutation(key, genParams, rng);
-					break;
-				}
-				case INVERSION: {
-					inversionMutation(key, genParams, rng);					
-					break;
-				}
-				default: {
-					std::cerr << "Invalid mutationType: " << genParams.mutationType << '\n';
-					throw InvalidParameters("Invalid Parameters: mutationType");
-				}
-			}
+			mutateKey(key, genParams, rng);
 			population[index] = key;
 			++index;
 		}
 		return population;
 	}
 
+	//	Mutates each member again while it is equivalent to a key in seen (see
+	//	Key::canonicalKey()), giving up after UNIQUE_TRIES tries. The canonical forms
+	//	of all members are added to seen.
+	pop_t& mutateDuplicates(pop_t &population, unordered_set<string> &seen,
+			const GenParams &genParams, rng_t &rng) {
+		for(unsigned index = 0; index < population.size(); index++) {
+			for(unsigned tries = 0; !seen.insert(Key::canonicalKey(population[index])).second &&
+					tries < UNIQUE_TRIES; tries++) {
+				mutateKey(population[index], genParams, rng);
+			}
+		}
+		return population;
+	}
+
 }
 
 
 pop_t& PlayfairGenetic::initializePopulationRandom(unsigned popSize, pop_t &population, rng_t &rng) {
 	population.clear();
 	population.reserve(popSize);
-	for(unsigned i = 0; i < popSize; i++) {
-		population.push_back(randomKey(rng));
+	unordered_set<string> seen;
+	for(unsigned tries = 0; population.size() < popSize; tries++) {
+		string key = randomKey(rng);
+		if(seen.insert(Key::canonicalKey(key)).second || tries >= UNIQUE_TRIES * popSize)
+			population.push_back(key);
 	}
 	return population;
 }
@@ -261,34 +380,55 @@ pop_t& PlayfairGenetic::initializePopulationRandom(unsigned popSize, pop_t &popu
 pop_t& PlayfairGenetic::initializePopulationSeed(unsigned popSize, pop_t &population, rng_t &rng, string seed) {
 	population.clear();
 	population.reserve(popSize);
-	for(unsigned i = 0; i < popSize; i++) {
-		population.push_back(seedKey(rng, seed));
+	//	A long seed leaves few keys to choose from, so duplicates are allowed once
+	//	new keys are hard to find
+	unordered_set<string> seen;
+	for(unsigned tries = 0; population.size() < popSize; tries++) {
+		string key = seedKey(rng, seed);
+		if(seen.insert(Key::canonicalKey(key)).second || tries >= UNIQUE_TRIES * popSize)
+			population.push_back(key);
 	}
 	return population;
 }
 
-pop_t& PlayfairGenetic::nextGeneration(const EnglishFitness &englishFit, const vector<char> &cipherText,
-	const GenParams &genParams, pop_t &population, rng_t &rng) {
-	//	get fitness scores for the population
-	vector<score_t> scores = fitnessPopulation(englishFit, population, cipherText);
+pop_t& PlayfairGenetic::nextGeneration(const Fitness &fitness, const vector<char> &cipherText,
+	const GenParams &genParams, pop_t &population, rng_t &rng, unsigned threads,
+	vector<score_t> *popScores, ScoreCache *cache) {
+	//	get fitness scores for the population, unless the caller already has them
+	vector<score_t> scores;
+	if(popScores && !popScores->empty()) {
+		if(popScores->size() != population.size())
+			throw InvalidParameters("Vector sizes do not match: population & scores");
+		scores.swap(*popScores);
+	} else {
+		fitnessPopulation(fitness, population, cipherText, threads, scores, cache);
+	}
 	//	Kill off the worst
-	for(unsigned index = 0; index < genParams.killWorst; index++) {
-		int worst = std::distance(scores.begin(), std::min_element(scores.begin(), scores.end()));
-		population.erase(population.begin()+worst);
-		scores.erase(scores.begin()+worst);
+	vector<unsigned> order;
+	killWorst(population, scores, genParams.killWorst, order);
+	vector<parents_t> pairs;
+	ParentSelection::selectParents(scores, genParams, rng, pairs);
+	pop_t parents;
+	parents.reserve(2 * pairs.size());
+	//	A member chosen in several pairs carries on only once
+	pop_t chosen;
+	unordered_set<unsigned> chosenIndex;
+	for(auto it = pairs.begin(); it != pairs.end(); ++it) {
+		parents.push_back(population[it->first]);
+		parents.push_back(population[it->second]);
+		if(chosenIndex.insert(it->first).second) chosen.push_back(population[it->first]);
+		if(chosenIndex.insert(it->second).second) chosen.push_back(population[it->second]);
 	}
-	std::pair<int, int> parents = selectParents(scores, rng);
-	
-	string p1 = population.at(parents.first);
-	string p2 = population.at(parents.second);
 
-	list<string> bestPop = keepBest(population, scores, genParams);
-	population.clear();
-	population.push_back(p1);
-	population.push_back(p2);
+	//	Members equivalent to another one would only be scored twice. The best
+	//	members are kept as they are, and new members equivalent to any member are
+	//	mutated further below.
+	unordered_set<string> seen;
+	vector<std::pair<string, score_t>> bestPop = keepBest(population, scores, genParams, order, seen);
+	population.swap(chosen);
 
 	try{
-		crossover(population, genParams, rng);
+		crossover(parents, population, genParams, rng);
 	} catch(InvalidKeyException e) {
 		std::cerr << "Crossover step produced an invalid key." << '\n';
 		throw;
@@ -308,17 +448,30 @@ pop_t& PlayfairGenetic::nextGeneration(const EnglishFitness &englishFit, const v
 		std::cerr << e.what() << '\n';
 	}
 
+	mutateDuplicates(population, seen, genParams, rng);
+
 	//	Add the best elements that we kept earlier
+	unsigned newMembers = population.size();
 	auto bestMember = bestPop.begin();
 	for(unsigned index = 0; index < bestPop.size(); index++) {
-		population.push_back(*bestMember++);
+		population.push_back((bestMember++)->first);
+	}
+
+	if(popScores) {
+		//	The kept members at the end are unchanged, so only the new members are scored
+		popScores->resize(newMembers);
+		for(auto it = bestPop.begin(); it != bestPop.end(); ++it) {
+			popScores->push_back(it->second);
+		}
+		fitnessPopulation(fitness, population, cipherText, threads, *popScores, cache, newMembers);
 	}
 	return population;
 }
 
-vector<score_t> PlayfairGenetic::fitScores(const EnglishFitness &englishFit, const pop_t &population,
-		const vector<char> &cipherText) {
-	return fitnessPopulation(englishFit, population, cipherText);
+vector<score_t> PlayfairGenetic::fitScores(const Fitness &fitness, const pop_t &population,
+		const vector<char> &cipherText, unsigned threads, ScoreCache *cache) {
+	vector<score_t> scores;
+	return fitnessPopulation(fitness, population, cipherText, threads, scores, cache);
 }
 
 std::pair<string, score_t> PlayfairGenetic::bestMember(const pop_t &population, const vector<score_t> &scores) {
@@ -327,3 +480,29 @@ std::pair<string, score_t> PlayfairGenetic::bestMember(const pop_t &population,
 	return std::pair<string, score_t> (population.at(best), scores.at(best));
 }
 
+vector<pop_t>& PlayfairGenetic::migrate(vector<pop_t> &islands, vector<vector<score_t>> &scores) {
+	if(islands.size() != scores.size())
+		throw InvalidParameters("Vector sizes do not match: islands & scores");
+
+	vector<std::pair<string, score_t>> migrants;
+	migrants.reserve(islands.size());
+	for(unsigned index = 0; index < islands.size(); index++) {
+		if(islands.at(index).size() != scores.at(index).size())
+			throw InvalidParameters("Vector sizes do not match: population & scores");
+		migrants.push_back(bestMember(islands.at(index), scores.at(index)));
+	}
+	for(unsigned index = 0; index < islands.size(); index++) {
+		unsigned next = (index + 1) % islands.size();
+		//	An island that already holds the migrant's square gains nothing from it
+		string square = Key::canonicalKey(migrants.at(index).first);
+		const pop_t &nextIsland = islands.at(next);
+		if(std::any_of(nextIsland.begin(), nextIsland.end(),
+				[&](const string &member){ return Key::canonicalKey(member) == square; }))
+			continue;
+		vector<score_t> &nextScores = scores.at(next);
+		int worst = std::distance(nextScores.begin(), std::min_element(nextScores.begin(), nextScores.end()));
+		islands.at(next).at(worst) = migrants.at(index).first;
+		nextScores.at(worst) = migrants.at(index).second;
+	}
+	return islands;
+}
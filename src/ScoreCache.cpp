@@ -0,0 +1,90 @@
+/* PlayfairCracker - Crack Playfair Encryptions
+ * Copyright (C) 2018 Yesha Maggi
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#include "ScoreCache.hpp"
+#include <functional>
+
+using std::string;
+
+ScoreCache::ScoreCache(std::size_t capacity)
+		: shardCapacity((capacity + SCORE_CACHE_SHARDS - 1) / SCORE_CACHE_SHARDS),
+		shards(SCORE_CACHE_SHARDS), hitCount(0), missCount(0) {
+	for(auto it = shards.begin(); it != shards.end(); ++it) {
+		it->scores.reserve(shardCapacity);
+		it->order.reserve(shardCapacity);
+	}
+}
+
+ScoreCache::~ScoreCache() {}
+
+bool ScoreCache::find(const string &square, score_t &score) {
+	Shard &shard = shardOf(square);
+	std::lock_guard<std::mutex> guard(shard.lock);
+	auto it = shard.scores.find(square);
+	if(it == shard.scores.end()) {
+		++missCount;
+		return false;
+	}
+	++hitCount;
+	score = it->second;
+	return true;
+}
+
+void ScoreCache::insert(const string &square, score_t score) {
+	if(shardCapacity == 0)
+		return;
+	Shard &shard = shardOf(square);
+	std::lock_guard<std::mutex> guard(shard.lock);
+	if(!shard.scores.emplace(square, score).second)
+		return;
+	if(shard.order.size() < shardCapacity) {
+		shard.order.push_back(square);
+		return;
+	}
+	//	Full, so the oldest key makes way for this one
+	shard.scores.erase(shard.order[shard.oldest]);
+	shard.order[shard.oldest] = square;
+	shard.oldest = (shard.oldest + 1) % shardCapacity;
+}
+
+void ScoreCache::clear() {
+	for(auto it = shards.begin(); it != shards.end(); ++it) {
+		std::lock_guard<std::mutex> guard(it->lock);
+		it->scores.clear();
+		it->order.clear();
+		it->oldest = 0;
+	}
+}
+
+std::size_t ScoreCache::size() {
+	std::size_t total = 0;
+	for(auto it = shards.begin(); it != shards.end(); ++it) {
+		std::lock_guard<std::mutex> guard(it->lock);
+		total += it->scores.size();
+	}
+	return total;
+}
+
+unsigned long ScoreCache::hits() const {
+	return hitCount;
+}
+
+unsigned long ScoreCache::misses() const {
+	return missCount;
+}
+
+ScoreCache::Shard &ScoreCache::shardOf(const string &square) {
+	return shards[std::hash<string>()(square) % SCORE_CACHE_SHARDS];
+}
@@ -0,0 +1,158 @@
+/* PlayfairCracker - Crack Playfair Encryptions
+ * Copyright (C) 2018 Yesha Maggi
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "SimulatedAnnealing.hpp"
+#include "Key.hpp"
+#include "PfHelpers.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using std::vector;
+using std::string;
+
+/// One in SWAP_ODDS moves is a shuffleKey() move, the rest swap two letters
+#define SWAP_ODDS 50
+
+namespace {
+	string& swapRows(string &key, int first, int second) {
+		std::swap_ranges(key.begin() + 5 * first, key.begin() + 5 * first + 5,
+			key.begin() + 5 * second);
+		return key;
+	}
+
+	string& swapColumns(string &key, int first, int second) {
+		for(int row = 0; row < 5; row++) {
+			std::swap(key[5 * row + first], key[5 * row + second]);
+		}
+		return key;
+	}
+
+	//	Copies the changed digrams of from into to
+	vector<char>& copyChanged(const vector<char> &from, vector<char> &to,
+			const vector<std::size_t> &changed) {
+		for(auto it = changed.begin(); it != changed.end(); ++it) {
+			to[*it] = from[*it];
+			to[*it + 1] = from[*it + 1];
+		}
+		return to;
+	}
+}
+
+string& SimulatedAnnealing::shuffleKey(string &key, rng_t &rng) {
+	std::uniform_int_distribution<int> move(0, 4);
+	std::uniform_int_distribution<int> line(0, 4);
+	switch(move(rng)) {
+		case 0: {
+			int first = line(rng);
+			int second = line(rng);
+			swapRows(key, first, second);
+			break;
+		}
+		case 1: {
+			int first = line(rng);
+			int second = line(rng);
+			swapColumns(key, first, second);
+			break;
+		}
+		case 2: {
+			//	Top to bottom
+			swapRows(key, 0, 4);
+			swapRows(key, 1, 3);
+			break;
+		}
+		case 3: {
+			//	Left to right
+			swapColumns(key, 0, 4);
+			swapColumns(key, 1, 3);
+			break;
+		}
+		default: {
+			std::reverse(key.begin(), key.end());
+		}
+	}
+	return key;
+}
+
+std::pair<string, score_t> SimulatedAnnealing::anneal(const Fitness &fitness,
+		const vector<char> &cipherText, const AnnealParams &params, string key, rng_t &rng) {
+	if(!PfHelpers::validKey(key)) {
+		throw InvalidKeyException("InvalidKeyException in anneal()");
+	}
+	std::uniform_int_distribution<int> moveType(0, SWAP_ODDS - 1);
+	std::uniform_int_distribution<int> place(0, 24);
+	std::uniform_real_distribution<double> chance(0, 1);
+
+	//	The current key, its decryption and score. candText is kept equal to curText
+	//	between moves, so a letter swap only has to update the digrams it changes.
+	Key curKey(key);
+	vector<char> curText = curKey.decrypt(cipherText);
+	vector<char> candText = curText;
+	score_t curScore = fitness.score(curText);
+	vector<std::size_t> changed;
+
+	string best = key;
+	score_t bestScore = curScore;
+	for(double temp = params.temperature; temp >= 0; temp -= params.step) {
+		for(unsigned iteration = 0; iteration < params.count; iteration++) {
+			bool swapMove = moveType(rng) != 0;
+			int first = 0, second = 0;
+			score_t candScore;
+			string candKey;
+			if(swapMove) {
+				first = place(rng);
+				second = place(rng);
+				while(first == second) {
+					second = place(rng);
+				}
+				curKey.decryptSwap(cipherText, candText, key[first], key[second], changed);
+				candScore = fitness.rescore(curText, curScore, candText, changed);
+			} else {
+				candKey = key;
+				shuffleKey(candKey, rng);
+				Key(candKey).decrypt(cipherText, candText);
+				candScore = fitness.score(candText);
+			}
+
+			score_t diff = candScore - curScore;
+			bool accept = diff >= 0 || (temp > 0 && std::exp(diff / temp) > chance(rng));
+			if(swapMove) {
+				if(accept) {
+					std::swap(key[first], key[second]);
+					copyChanged(candText, curText, changed);
+				} else {
+					curKey.swapLetters(key[first], key[second]);
+					copyChanged(curText, candText, changed);
+				}
+			} else {
+				if(accept) {
+					key = candKey;
+					curKey = Key(key);
+					curText = candText;
+				} else {
+					candText = curText;
+				}
+			}
+			if(accept) {
+				curScore = candScore;
+				if(curScore > bestScore) {
+					best = key;
+					bestScore = curScore;
+				}
+			}
+		}
+	}
+	//	Letter swaps add up score differences, so score the best key once more exactly
+	return std::pair<string, score_t> (best, fitness.score(Key(best).decrypt(cipherText)));
+}
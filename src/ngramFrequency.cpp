@@ -13,11 +13,15 @@
  */
 
 #include "FrequencyCollector.hpp"
+#include "NgramTable.hpp"
 #include "optionparser.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <sys/ioctl.h>
+#include <algorithm>
+#include <exception>
+#include <thread>
 #include <vector>
 
 struct Arg: public option::Arg {
@@ -55,12 +59,52 @@ std::ifstream::pos_type fileSize(const std::string fileName) {
     return in.tellg(); 
 }
 
-enum  optionIndex { UNKNOWN, HELP, METHOD, TEXT, OUTPUTFILE, N };
-enum  method { COLLECT, VALID };
+/**
+ * Adds the counts in fileName to fC, whether it is a text or binary count file.
+ */
+void readCounts(FrequencyCollector &fC, const char* fileName) {
+    if(NgramTable::isTableFile(fileName))
+        fC.readNgramTable(fileName);
+    else
+        fC.readNgramCount(fileName);
+}
+
+/**
+ * Reads many count files on up to threads threads, each thread into its own
+ * FrequencyCollector, then merges them all into fC.
+ */
+void readAllCounts(FrequencyCollector &fC, const std::vector<const char*> &files, unsigned threads) {
+    threads = std::max(1u, std::min<unsigned>(threads, files.size()));
+    std::vector<FrequencyCollector> parts(threads, FrequencyCollector(fC.getN()));
+    std::vector<std::exception_ptr> errors(threads);
+    std::vector<std::thread> workers;
+    for(unsigned t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            try {
+                for(unsigned i = t; i < files.size(); i += threads) {
+                    readCounts(parts[t], files[i]);
+                }
+            } catch(...) {
+                errors[t] = std::current_exception();
+            }
+        });
+    }
+    for(auto it = workers.begin(); it != workers.end(); ++it) {
+        it->join();
+    }
+    for(unsigned t = 0; t < threads; t++) {
+        if(errors[t]) std::rethrow_exception(errors[t]);
+        fC += parts[t];
+    }
+}
+
+enum  optionIndex { UNKNOWN, HELP, METHOD, TEXT, OUTPUTFILE, BINARY, THREADS, N };
+enum  method { COLLECT, VALID, CONVERT };
 const option::Descriptor usage[] = {
 { UNKNOWN,   0,"",  "",       Arg::Unknown, "USAGE: ngramFrequency [OPTION]... -n N FILE...\n"
                                             "       ngramFrequency [OPTION]... -n N -t TEXT\n"
-                                            "       ngramFrequency [OPTION]... -v -n N FILE..."},
+                                            "       ngramFrequency [OPTION]... -v -n N FILE...\n"
+                                            "       ngramFrequency [OPTION]... -r -n N -o FILE FILE..."},
 { N,         0,"n", "n",      Arg::Numeric, "\nPARAMETERS:\n"
                                             "  -n,        \t"
                                             "\tN, the size of n-gram being worked with (i.e. 2 = bigram)"},
@@ -71,13 +115,20 @@ const option::Descriptor usage[] = {
                                             "\tRead file and collect n-gram frequencies"},
 { METHOD,    1,"v", "valid",  Arg::None,    "  -v,        \t--valid"
                                             "\tChecks if file contains valid n-gram counts" },
+{ METHOD,    2,"r", "read",   Arg::None,    "  -r,        \t--read"
+                                            "\tRead and add up n-gram count files (text or binary) instead of text" },
 { TEXT,      0,"t", "text",   Arg::NonEmpty,"  -t <FILE>, \t--text=<TEXT>"},
 { OUTPUTFILE,0,"o", "output", Arg::NonEmpty,"  -o <FILE>, \t--output=<FILE>"},
+{ BINARY,    0,"b", "binary", Arg::None,    "  -b,        \t--binary"
+                                            "\tWrite output as a binary table that loads without parsing (N <= 5)" },
+{ THREADS,   0,"j", "threads",Arg::Numeric, "  -j <NUM>,  \t--threads=<NUM>"
+                                            "\tRead files on NUM threads (0 = one per core)" },
 { UNKNOWN,   0,"",  "",       Arg::None,
  "EXAMPLES:\n"
  "  ngramFrequency -n 2 -t \"collect n-gram frequencies!\"\n"
  "  ngramFrequency -c -n 3 -o trigrams.txt english.txt\n"
- "  ngramFrequency -v -n 4 trigrams.txt\n" },
+ "  ngramFrequency -v -n 4 trigrams.txt\n"
+ "  ngramFrequency -r -b -n 4 -o quadgrams.bin english_quadgrams.txt\n" },
 { 0, 0, 0, 0, 0, 0 } };
 
 int main(int argc, char* argv[]) {
@@ -106,6 +157,13 @@ int main(int argc, char* argv[]) {
     }
     unsigned n = atoi(options[N].last()->arg);
 
+    unsigned threads = 1;
+    if(options[THREADS]) {
+        threads = strtoul(options[THREADS].last()->arg, NULL, 10);
+        if(!threads)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
     if(!options[TEXT] && (parse.nonOptionsCount() == 0) ) {
         fprintf(stderr, "Usage requires either -t flag or file argument.\n");
         fprintf(stderr, "Try 'ngramFrequency --help' for more information.\n");
@@ -137,30 +195,49 @@ int main(int argc, char* argv[]) {
             return 0;            
         }
 
-        if(options[TEXT]) {
-            std::stringstream ss(options[TEXT].last()->arg);
-            fC.collectNGrams(ss);
+        if(options[BINARY] && !options[OUTPUTFILE]) {
+            fprintf(stderr, "Binary output requires -o flag.\n");
+            fprintf(stderr, "Try 'ngramFrequency --help' for more information.\n");
+            return 1;
         }
-        
-        for(int i = 0; i < parse.nonOptionsCount(); i++) {
-            fC.collectNGramsFile(parse.nonOption(i));
+
+        if(options[METHOD] && options[METHOD].last()->type() == CONVERT) {
+            std::vector<const char*> files;
+            for(int i = 0; i < parse.nonOptionsCount(); i++) {
+                files.push_back(parse.nonOption(i));
+            }
+            readAllCounts(fC, files, threads);
+        } else {
+            if(options[TEXT]) {
+                std::stringstream ss(options[TEXT].last()->arg);
+                fC.collectNGrams(ss);
+            }
+
+            std::vector<const char*> files;
+            for(int i = 0; i < parse.nonOptionsCount(); i++) {
+                files.push_back(parse.nonOption(i));
+            }
+            fC.collectNGramsFiles(files, threads);
         }
-            
 
         if(options[OUTPUTFILE]) {
             FILE *file      ;
             if((file = fopen(options[OUTPUTFILE].last()->arg, "r") )) {
                 fclose(file);
-                fC.readNgramCount(options[OUTPUTFILE].last()->arg);
+                readCounts(fC, options[OUTPUTFILE].last()->arg);
             }
 
-            fC.writeNGramCount(options[OUTPUTFILE].last()->arg);
+            if(options[BINARY])
+                fC.writeNgramTable(options[OUTPUTFILE].last()->arg);
+            else
+                fC.writeNGramCount(options[OUTPUTFILE].last()->arg);
         } else {
             fC.printNGrams(std::cout);
         }
 
-    } catch(std::exception e) {
-        fprintf(stderr, "%s", e.what());
+    } catch(const std::exception &e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 2;
     }
 
     return 0;
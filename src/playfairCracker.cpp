@@ -13,10 +13,20 @@
  */
 
 #include "PlayfairGenetic.hpp"
+#include "SimulatedAnnealing.hpp"
+#include "EnglishFitness.hpp"
+#include "LogFitness.hpp"
+#include "NgramTable.hpp"
+#include "ScoreCache.hpp"
 #include "FrequencyCollector.hpp"
 #include "PfHelpers.hpp"
 #include "optionparser.h"
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <memory>
 #include <random>
+#include <thread>
 #include <sys/ioctl.h>
 
 using std::vector;
@@ -49,6 +59,14 @@ struct Arg: public option::Arg {
         return option::ARG_ILLEGAL;
     }
 
+    static option::ArgStatus Real(const option::Option& option, bool msg) {
+        if (option.arg != 0 && PfHelpers::isDouble(option.arg))
+          return option::ARG_OK;
+
+        if (msg) printError("Option '", option, "' requires a non-negative decimal number\n");
+        return option::ARG_ILLEGAL;
+    }
+
     static option::ArgStatus NonEmpty(const option::Option& option, bool msg) {
         if (option.arg != 0 && option.arg[0] != 0)
           return option::ARG_OK;
@@ -59,11 +77,14 @@ struct Arg: public option::Arg {
 };
 
 enum  optionIndex { UNKNOWN, HELP, METHOD, OUTFILE, VERBOSE, PARAMS, SEED, RNG,
-	CHILDS, RANDOM, MUTATION, KILL, BEST };
-enum  method { GENS, DORM };
+	FITNESS, THREADS, ISLANDS, MIGRATE, CACHE, CHILDS, RANDOM, MUTATION, KILL, BEST, SELECT,
+	TSIZE, PAIRS, TEMP, STEP, COUNT };
+enum  method { GENS, DORM, ANNEAL };
+enum  fitnessFunction { DISTANCE, DISTANCE_SPARSE, LOG_PROBABILITY };
 const option::Descriptor usage[] = {
 { UNKNOWN,  0,"",  "",       Arg::Unknown,  "USAGE: playfairCracker -g NUM [OPTION]... CIPHER FREQ\n"
-                                            "       playfairCracker -s NUM [OPTION]... CIPHER FREQ\n"
+                                            "       playfairCracker -d NUM [OPTION]... CIPHER FREQ\n"
+                                            "       playfairCracker -n NUM [OPTION]... CIPHER FREQ\n"
                                         	"\nDESCRIPTION: See full documentation for more details.\n"
                                         	"	CIPHER is the file containing the cipherText\n"
                                         	"	FREQ is the file containing the standard n-gram frequencies"},
@@ -72,6 +93,8 @@ const option::Descriptor usage[] = {
 										    "\tAlgorithm runs for NUM generations"},
 { METHOD,   1,"d", "d",      Arg::Numeric,  "  -d <NUM>, \t--d=<NUM>"
 										    "\tAlgorithm runs until dormant for NUM generations"},
+{ METHOD,   2,"n", "anneal", Arg::Numeric,  "  -n <NUM>, \t--anneal=<NUM>"
+										    "\tSimulated annealing, from NUM starting keys"},
 { HELP,     0,"",  "help",   Arg::None,     "\nOPTIONS:\n"
 										    "\t--help"
                                             "\tPrint usage and exit"},
@@ -81,6 +104,17 @@ const option::Descriptor usage[] = {
 											"\tSeed to initialize population with"},
 { VERBOSE,	0,"v", "verbose",Arg::Numeric,  "  -v <NUM>,\t--verbose=<NUM>"
 											"\tEvery NUM generations, be verbose"},
+{ FITNESS,	0,"f", "fitness",Arg::Numeric,  "  -f <NUM>,\t--fitness=<NUM>"
+											"\tFitness function: 0 distance (default), 1 sparse distance, "
+											"2 log probability"},
+{ THREADS,	0,"j", "threads",Arg::Numeric,  "  -j <NUM>,\t--threads=<NUM>"
+											"\tScore population on NUM threads (0 = one per core)"},
+{ ISLANDS,	0,"i", "islands",Arg::Numeric,  "  -i <NUM>,\t--islands=<NUM>"
+											"\tEvolve NUM separate populations (default 1)"},
+{ MIGRATE,	0,"",  "migrate",Arg::Numeric,  "  --migrate=<NUM>"
+											"\tIslands exchange their best keys every NUM generations (default 10)"},
+{ CACHE,	0,"",  "cache",  Arg::Numeric,  "  --cache=<NUM>"
+											"\tRemember the scores of NUM keys (default 100000, 0 = off)"},
 { CHILDS,	0,"c", "children",Arg::Numeric, "\nPARAMETERS: These take precedence over params file\n"
 											"  -c <NUM>, \t--children=<NUM>"
 											"\tNUM children produced each generation"},
@@ -92,6 +126,21 @@ const option::Descriptor usage[] = {
 											"\tNUM worst members of population killed before parent selection"},
 { BEST, 	0,"b", "best",	 Arg::Numeric,  "  -b <NUM>, \t--best=<NUM>"
 											"\tNUM best members that will continue next generation"},
+{ SELECT, 	0,"",  "select", Arg::Numeric,  "  --select=<NUM>"
+											"\tParent selection: 0 roulette (default), 1 stochastic universal "
+											"sampling, 2 tournament"},
+{ TSIZE, 	0,"",  "tournament",Arg::Numeric,"  --tournament=<NUM>"
+											"\tNUM members in each tournament (default 2)"},
+{ PAIRS, 	0,"",  "pairs",  Arg::Numeric,  "  --pairs=<NUM>"
+											"\tNUM parent pairs selected each generation (default 1). Every distinct"
+											" parent carries on, so more pairs can mean a larger population"},
+{ TEMP,     0,"",  "temp",   Arg::Real,     "\nANNEALING: Used with -n\n"
+											"  --temp=<NUM>"
+											"\tStarting temperature (default 20)"},
+{ STEP,     0,"",  "step",   Arg::Real,     "  --step=<NUM>"
+											"\tTemperature is lowered by NUM (default 0.2)"},
+{ COUNT,    0,"",  "count",  Arg::Numeric,  "  --count=<NUM>"
+											"\tNUM keys tried at each temperature (default 10000)"},
 { RNG,      0,"",  "rng",    Arg::Numeric, 0 },
 { 0, 0, 0, 0, 0, 0 } };
 
@@ -112,42 +161,78 @@ bool setParam(std::unordered_map<string, string> &paramMap, unsigned &param, str
 	return true;
 }
 
-int main(int argc, char* argv[]) {
-    argc-=(argc>0); argv+=(argc>0); // skip program name argv[0] if present
-    option::Stats stats(usage, argc, argv);
-
-    std::vector<option::Option> options(stats.options_max);
-    std::vector<option::Option> buffer(stats.buffer_max);
-    option::Parser parse(usage, argc, argv, &options[0], &buffer[0], 3);
-
-    if(parse.error())
-        return 1;
-
-    if(options[HELP] || argc == 0) {
-        struct winsize w;
-        ioctl(0, TIOCGWINSZ, &w);
-        int columns = w.ws_col ? w.ws_col : 80;
-        option::printUsage(fwrite, stdout, usage, columns);
-        return 0;
-    }
-
-    unsigned verbose = options[VERBOSE].count();
-    unsigned verboseGen = 1;
-    if(verbose) {
-    	verboseGen = strtoul(options[VERBOSE].last()->arg, NULL, 10);
-    }
+/**
+ * Builds the fitness function chosen with -f from either FrequencyCollector or
+ * 	NgramTable. Returns nullptr for an unknown fitnessType.
+ */
+template <typename Frequencies>
+Fitness *makeFitness(unsigned fitnessType, const Frequencies &standard) {
+	switch(fitnessType) {
+		case DISTANCE:
+			return new EnglishFitness(standard, DENSE);
+		case DISTANCE_SPARSE:
+			return new EnglishFitness(standard, SPARSE);
+		case LOG_PROBABILITY:
+			return new LogFitness(standard);
+		default:
+			return nullptr;
+	}
+}
 
-    if(!options[METHOD]) {
-        fprintf(stderr, "Usage requires either -g or -s flag flag.\n");
-        fprintf(stderr, "See documentation for more details.\n");
-        return 1;
-    }
+/**
+ * Calls task(index) for each index below count, spread over up to threads threads.
+ * 	Returns the first exception thrown by a task, if any, once all threads are done.
+ */
+std::exception_ptr runParallel(unsigned count, unsigned threads,
+		const std::function<void(unsigned)> &task) {
+	vector<std::exception_ptr> errors(count);
+	auto worker = [&](unsigned first, unsigned stride) {
+		for(unsigned index = first; index < count; index += stride) {
+			try {
+				task(index);
+			} catch(...) {
+				errors[index] = std::current_exception();
+			}
+		}
+	};
+	unsigned workers = std::min(threads, count);
+	if(workers <= 1) {
+		worker(0, 1);
+	} else {
+		vector<std::thread> pool;
+		for(unsigned t = 0; t < workers; t++) {
+			pool.emplace_back(worker, t, workers);
+		}
+		for(auto it = pool.begin(); it != pool.end(); ++it) {
+			it->join();
+		}
+	}
+	for(auto it = errors.begin(); it != errors.end(); ++it) {
+		if(*it)
+			return *it;
+	}
+	return std::exception_ptr();
+}
 
-    if(parse.nonOptionsCount() != 2) {
-    	fprintf(stderr, "Usage requires exactly 2 arguments.\n");
-    	return 1;
-    }
+/**
+ * Prints the message of an exception from runParallel(). Returns the exit code for main().
+ */
+int reportError(std::exception_ptr error) {
+	try {
+		std::rethrow_exception(error);
+	} catch(std::exception &e) {
+		std::cerr << e.what() << '\n';
+	} catch(...) {
+		std::cerr << "Unknown error" << '\n';
+	}
+	return 4;
+}
 
+/**
+ * Reads the genetic algorithm parameters from the parameter flags and params file.
+ * 	Returns the exit code for main() on error, 0 otherwise.
+ */
+int readGenParams(const std::vector<option::Option> &options, GenParams &params) {
     // Parameters
 	unsigned children;
 	unsigned addRandom;
@@ -209,40 +294,144 @@ int main(int argc, char* argv[]) {
 	    	return 3;
 	} else keepBest = strtoul(options[BEST].last()->arg, NULL, 10);
 
-	GenParams params { children, addRandom, mutationType, killWorst, keepBest };
+	//	Parent selection has defaults, so older parameters files still work
+	unsigned selection = ROULETTE;
+	unsigned tournamentSize = 2;
+	unsigned parentPairs = 1;
+	if(!options[SELECT]) {
+		if(paramMap.count("selection") && !setParam(paramMap, selection, "selection"))
+			return 3;
+	} else selection = strtoul(options[SELECT].last()->arg, NULL, 10);
+
+	if(!options[TSIZE]) {
+		if(paramMap.count("tournamentSize") && !setParam(paramMap, tournamentSize, "tournamentSize"))
+			return 3;
+	} else tournamentSize = strtoul(options[TSIZE].last()->arg, NULL, 10);
+
+	if(!options[PAIRS]) {
+		if(paramMap.count("parentPairs") && !setParam(paramMap, parentPairs, "parentPairs"))
+			return 3;
+	} else parentPairs = strtoul(options[PAIRS].last()->arg, NULL, 10);
+
+	if(selection > TOURNAMENT) {
+		fprintf(stderr, "Invalid parent selection: %u\n", selection);
+		return 3;
+	}
 
+	params = GenParams { children, addRandom, mutationType, killWorst, keepBest,
+		selection, tournamentSize, parentPairs };
+	return 0;
+}
 
-	unsigned n;
-	const char *fileName = parse.nonOption(1);
-	try {
-		std::ifstream fileReader(fileName);
-		if(!fileReader) {
-            fprintf(stderr, "%s can not be opened.\n", parse.nonOption(1));
-            return 2;
-        }
-       	fileReader.ignore(50, ' ');
-       	n = fileReader.gcount() - 1;
-	} catch(std::ios_base::failure e) {
-		fprintf(stderr, "Error with frequency file '%s'", parse.nonOption(1));
-		return 2;
+int main(int argc, char* argv[]) {
+    argc-=(argc>0); argv+=(argc>0); // skip program name argv[0] if present
+    option::Stats stats(usage, argc, argv);
+
+    std::vector<option::Option> options(stats.options_max);
+    std::vector<option::Option> buffer(stats.buffer_max);
+    option::Parser parse(usage, argc, argv, &options[0], &buffer[0], 3);
+
+    if(parse.error())
+        return 1;
+
+    if(options[HELP] || argc == 0) {
+        struct winsize w;
+        ioctl(0, TIOCGWINSZ, &w);
+        int columns = w.ws_col ? w.ws_col : 80;
+        option::printUsage(fwrite, stdout, usage, columns);
+        return 0;
+    }
+
+    unsigned threads = 1;
+    if(options[THREADS]) {
+    	threads = strtoul(options[THREADS].last()->arg, NULL, 10);
+    	if(!threads)
+    		threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    unsigned verbose = options[VERBOSE].count();
+    unsigned verboseGen = 1;
+    if(verbose) {
+    	verboseGen = strtoul(options[VERBOSE].last()->arg, NULL, 10);
+    }
+
+    if(!options[METHOD]) {
+        fprintf(stderr, "Usage requires either -g, -d or -n flag.\n");
+        fprintf(stderr, "See documentation for more details.\n");
+        return 1;
+    }
+
+    if(parse.nonOptionsCount() != 2) {
+    	fprintf(stderr, "Usage requires exactly 2 arguments.\n");
+    	return 1;
+    }
+
+	bool annealing = options[METHOD].last()->type() == ANNEAL;
+	GenParams params {};
+	if(!annealing) {
+		int error = readGenParams(options, params);
+		if(error) return error;
 	}
 
-	// Initialize standardFreq
-	// Get standardFrequencies
-	FrequencyCollector standardFreq(n);
-	try {
-		standardFreq.readNgramCount(fileName);
-	} catch (std::ifstream::failure e) {
-		std::cerr << e.what() << '\n';
-		return 2;
+
+	unsigned fitnessType = DISTANCE;
+	if(options[FITNESS]) {
+		fitnessType = strtoul(options[FITNESS].last()->arg, NULL, 10);
+	}
+	std::unique_ptr<Fitness> fitness;
+	const char *fileName = parse.nonOption(1);
+	if(NgramTable::isTableFile(fileName)) {
+		//	Binary tables are mapped and used as they are, no parsing
+		try {
+			NgramTable standardTable(fileName);
+			fitness.reset(makeFitness(fitnessType, standardTable));
+		} catch(const std::ios_base::failure &e) {
+			std::cerr << e.what() << '\n';
+			return 2;
+		} catch(const Exception &e) {
+			std::cerr << e.what() << '\n';
+			return 2;
+		}
+	} else {
+		unsigned n;
+		try {
+			std::ifstream fileReader(fileName);
+			if(!fileReader) {
+				fprintf(stderr, "%s can not be opened.\n", parse.nonOption(1));
+				return 2;
+			}
+			fileReader.ignore(50, ' ');
+			n = fileReader.gcount() - 1;
+		} catch(const std::ios_base::failure &e) {
+			fprintf(stderr, "Error with frequency file '%s'", parse.nonOption(1));
+			return 2;
+		}
+
+		// Initialize standardFreq
+		// Get standardFrequencies
+		FrequencyCollector standardFreq(n);
+		try {
+			standardFreq.readNgramCount(fileName);
+			fitness.reset(makeFitness(fitnessType, standardFreq));
+		} catch(const std::ifstream::failure &e) {
+			std::cerr << e.what() << '\n';
+			return 2;
+		} catch(const Exception &e) {
+			std::cerr << e.what() << '\n';
+			return 2;
+		}
+	}
+	if(!fitness) {
+		fprintf(stderr, "Invalid fitness function: %u\n", fitnessType);
+		fprintf(stderr, "See documentation for more details.\n");
+		return 1;
 	}
-	EnglishFitness englishFit(standardFreq);
 
 	//	Read cipher text
 	vector<char> cipherText;
 	try {
 		PfHelpers::readFile(parse.nonOption(0), cipherText);
-	} catch (std::ifstream::failure e) {
+	} catch(const std::ifstream::failure &e) {
 		std::cerr << e.what() << '\n';
 		return 2;
 	}
@@ -256,13 +445,99 @@ int main(int argc, char* argv[]) {
     	rng.seed(strtol(options[RNG].last()->arg, NULL, 10));
     }
 
-	// Initialize population
-	pop_t population;
-	unsigned initialSize = 2 + children + addRandom;
-	if(options[SEED]) {
-		PlayfairGenetic::initializePopulationSeed(initialSize, population, rng, options[SEED].last()->arg);
+	if(annealing) {
+		AnnealParams annealParams { 20, 0.2, 10000 };
+		if(options[TEMP])
+			annealParams.temperature = strtod(options[TEMP].last()->arg, NULL);
+		if(options[STEP])
+			annealParams.step = strtod(options[STEP].last()->arg, NULL);
+		if(options[COUNT])
+			annealParams.count = strtoul(options[COUNT].last()->arg, NULL, 10);
+		if(annealParams.step <= 0) {
+			fprintf(stderr, "Annealing requires a positive --step.\n");
+			return 1;
+		}
+
+		//	Each run gets its own starting key and generator, drawn here in order, so
+		//	the results do not depend on the number of threads
+		unsigned runs = strtoul(options[METHOD].last()->arg, NULL, 10);
+		pop_t starts;
+		if(options[SEED]) {
+			PlayfairGenetic::initializePopulationSeed(runs, starts, rng, options[SEED].last()->arg);
+		} else {
+			PlayfairGenetic::initializePopulationRandom(runs, starts, rng);
+		}
+		vector<rng_t> runRngs;
+		for(unsigned run = 0; run < runs; run++) {
+			runRngs.emplace_back(rng(), run);
+		}
+
+		PfHelpers::Timer timer;
+		vector<std::pair<string, score_t>> results(runs);
+		std::exception_ptr error = runParallel(runs, threads, [&](unsigned run) {
+			results[run] = SimulatedAnnealing::anneal(*fitness, cipherText,
+				annealParams, starts[run], runRngs[run]);
+		});
+		if(error)
+			return reportError(error);
+
+		std::pair<string, score_t> best("", 0);
+		for(unsigned run = 0; run < runs; run++) {
+			if(verbose) {
+				std::cout << "Run " << run + 1 << ": " << results[run].first << "  " <<
+					results[run].second << '\n';
+			}
+			if(run == 0 || results[run].second > best.second)
+				best = results[run];
+		}
+		std::cout << "Finished after " << runs << " runs\n";
+		std::cout << "Best member: " << best.first << "  " << best.second << "\n";
+
+		std::cout << "Timer: " << timer.elapsed() << " seconds" << '\n';
+		return 0;
+	}
+
+	//	Islands evolve separately, each with its own stream of random numbers. A single
+	//	island keeps using rng, so it evolves exactly as one population always has.
+	unsigned numIslands = 1;
+	if(options[ISLANDS])
+		numIslands = std::max(1ul, strtoul(options[ISLANDS].last()->arg, NULL, 10));
+	unsigned migrateGen = 10;
+	if(options[MIGRATE])
+		migrateGen = strtoul(options[MIGRATE].last()->arg, NULL, 10);
+	vector<rng_t> rngs;
+	if(numIslands == 1) {
+		rngs.push_back(rng);
 	} else {
-		PlayfairGenetic::initializePopulationRandom(initialSize, population, rng);
+		rng_t::result_type islandSeed = rng();
+		for(unsigned island = 0; island < numIslands; island++) {
+			rngs.emplace_back(islandSeed, island);
+		}
+	}
+	//	One cache is shared by all islands, so a key found on any of them is not
+	//	decrypted again
+	unsigned long cacheSize = 100000;
+	if(options[CACHE])
+		cacheSize = strtoul(options[CACHE].last()->arg, NULL, 10);
+	std::unique_ptr<ScoreCache> cache;
+	if(cacheSize)
+		cache.reset(new ScoreCache(cacheSize));
+
+	//	Threads are shared out between islands first, then between members
+	unsigned islandThreads = std::max(1u, threads / numIslands);
+
+	// Initialize population
+	vector<pop_t> islands(numIslands);
+	//	As large as a generation can be: every parent pair distinct
+	unsigned initialSize = 2 * std::max(1u, params.parentPairs) + params.numChildren +
+		params.newRandom;
+	for(unsigned island = 0; island < numIslands; island++) {
+		if(options[SEED]) {
+			PlayfairGenetic::initializePopulationSeed(initialSize, islands[island], rngs[island],
+				options[SEED].last()->arg);
+		} else {
+			PlayfairGenetic::initializePopulationRandom(initialSize, islands[island], rngs[island]);
+		}
 	}
 	
 	unsigned generation = 0;
@@ -277,6 +552,7 @@ int main(int argc, char* argv[]) {
 		numDorm = strtol(options[METHOD].last()->arg, NULL, 0);
 	
 	PfHelpers::Timer timer;
+	vector<vector<score_t>> scores(numIslands);
 	while(true) {
 		++generation;
 		if(numGens && generation > numGens) {
@@ -288,16 +564,34 @@ int main(int argc, char* argv[]) {
 			break;
 		}
 
-		PlayfairGenetic::nextGeneration(englishFit, cipherText, params, population, rng);
-		if(verbose || numDorm) {
-			// Print each member and scores
-			vector<score_t> scores = PlayfairGenetic::fitScores(standardFreq, population, cipherText);
-			std::pair<string, score_t> bestIndex = PlayfairGenetic::bestMember(population, scores);
+		bool migrating = numIslands > 1 && migrateGen && generation % migrateGen == 0;
+		bool scoring = verbose || numDorm || migrating;
+		//	nextGeneration() leaves the scores of each new population in scores, and
+		//	picks them up again next generation, so they cost nothing extra here
+		std::exception_ptr error = runParallel(numIslands, threads, [&](unsigned island) {
+			PlayfairGenetic::nextGeneration(*fitness, cipherText, params, islands[island],
+				rngs[island], islandThreads, &scores[island], cache.get());
+		});
+		if(error)
+			return reportError(error);
+
+		if(scoring) {
+			std::pair<string, score_t> bestIndex = PlayfairGenetic::bestMember(islands[0], scores[0]);
+			for(unsigned island = 1; island < numIslands; island++) {
+				std::pair<string, score_t> islandBest = PlayfairGenetic::bestMember(islands[island], scores[island]);
+				if(islandBest.second > bestIndex.second)
+					bestIndex = islandBest;
+			}
 			if(verbose && generation % verboseGen == 0) {
+				// Print each member and scores
 				std::cout << "Generation " << generation << '\n';
 				if(verbose > 1) {
-					for(unsigned index = 0; index < population.size(); index++) {
-						std::cout << population.at(index) << "  " << scores.at(index) << '\n';
+					for(unsigned island = 0; island < numIslands; island++) {
+						if(numIslands > 1)
+							std::cout << "Island " << island + 1 << '\n';
+						for(unsigned index = 0; index < islands[island].size(); index++) {
+							std::cout << islands[island].at(index) << "  " << scores[island].at(index) << '\n';
+						}
 					}
 				}
 				std::cout << "Best member: " << bestIndex.first << "  " << bestIndex.second << "\n\n";
@@ -310,12 +604,24 @@ int main(int argc, char* argv[]) {
 				lastBest = bestIndex.second;
 			}
 		}
+		if(migrating)
+			PlayfairGenetic::migrate(islands, scores);
 	}
 
-	vector<score_t> scores = PlayfairGenetic::fitScores(standardFreq, population, cipherText);
-	std::pair<string, double> bestIndex = PlayfairGenetic::bestMember(population, scores);
+	std::pair<string, score_t> bestIndex("", 0);
+	for(unsigned island = 0; island < numIslands; island++) {
+		if(scores[island].empty())
+			scores[island] = PlayfairGenetic::fitScores(*fitness, islands[island], cipherText, threads);
+		std::pair<string, score_t> islandBest = PlayfairGenetic::bestMember(islands[island], scores[island]);
+		if(island == 0 || islandBest.second > bestIndex.second)
+			bestIndex = islandBest;
+	}
 	std::cout << "Finished after " << generation << " generations\n";
 	std::cout << "Best member: " << bestIndex.first << "  " << bestIndex.second << "\n";
+	if(verbose && cache && cache->hits() + cache->misses()) {
+		std::cout << "Score cache: " << cache->hits() << " hits, " << cache->misses() <<
+			" misses (" << 100.0 * cache->hits() / (cache->hits() + cache->misses()) << "%)\n";
+	}
 
 	std::cout << "Timer: " << timer.elapsed() << " seconds" << '\n';
 	return 0;
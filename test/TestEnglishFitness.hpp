@@ -0,0 +1,78 @@
+#include "cxxtest/TestSuite.h"
+#include "EnglishFitness.hpp"
+#include "FrequencyCollector.hpp"
+#include "PfHelpers.hpp"
+#include <sstream>
+
+using std::vector;
+using std::string;
+
+class TestEnglishFitness : public CxxTest::TestSuite {
+public:
+	vector<string> texts = {"The quick brown fox jumps over the lazy dog",
+							"It was the best of times, it was the worst of times",
+							"QXZQXZQXZVVVVKKKK",
+							"th"};
+	void testSparseMatchesDense(void) {
+		char fileName[] = "test/frequencies/freq_pass_1_1";
+		for(unsigned n = 1; n <= 3; n++) {
+			fileName[27] = '0' + n;
+			FrequencyCollector standardFreq(n);
+			standardFreq.readNgramCount(fileName);
+			EnglishFitness dense(standardFreq, DENSE);
+			EnglishFitness sparse(standardFreq, SPARSE);
+			TS_ASSERT_EQUALS(sparse.getMode(), SPARSE);
+
+			for(unsigned i = 0; i < texts.size(); i++) {
+				FrequencyCollector testFreq(n);
+				std::stringstream ss(texts.at(i));
+				testFreq.collectNGrams(ss);
+				if(testFreq.isEmpty()) continue;
+				score_t expected = dense.fitness(testFreq);
+				TS_ASSERT_DELTA(sparse.fitness(testFreq), expected, expected * 1e-9);
+			}
+		}
+	}
+
+	void testEmpty(void) {
+		FrequencyCollector standardFreq(2);
+		standardFreq.readNgramCount("test/frequencies/freq_pass_2_1");
+		FrequencyCollector empty(2);
+		for(unsigned mode = DENSE; mode <= SPARSE; mode++) {
+			EnglishFitness fit(standardFreq, FitnessMode(mode));
+			TS_ASSERT_THROWS(fit.fitness(empty), Exception);
+			FrequencyCollector trigrams(3);
+			std::stringstream ss(texts.at(0));
+			trigrams.collectNGrams(ss);
+			TS_ASSERT_THROWS(fit.fitness(trigrams), Exception);
+		}
+	}
+
+	void testScoreMatchesFitness(void) {
+		char fileName[] = "test/frequencies/freq_pass_1_1";
+		for(unsigned n = 1; n <= 3; n++) {
+			fileName[27] = '0' + n;
+			FrequencyCollector standardFreq(n);
+			standardFreq.readNgramCount(fileName);
+			for(unsigned mode = DENSE; mode <= SPARSE; mode++) {
+				EnglishFitness fit(standardFreq, FitnessMode(mode));
+				for(unsigned i = 0; i < texts.size(); i++) {
+					string letters;
+					for(char ch : texts.at(i)) {
+						if(isalpha(ch)) letters.push_back(toupper(ch));
+					}
+					FrequencyCollector testFreq(n);
+					testFreq.collectNGrams(letters.data(), letters.size());
+					if(testFreq.isEmpty()) continue;
+					score_t expected = fit.fitness(testFreq);
+					score_t scored = fit.score(vector<char>(letters.begin(), letters.end()));
+					if(mode == DENSE)
+						TS_ASSERT_EQUALS(scored, expected);
+					else
+						TS_ASSERT_DELTA(scored, expected, expected * 1e-9);
+				}
+				TS_ASSERT_THROWS(fit.score(vector<char>(n - 1, 'A')), Exception);
+			}
+		}
+	}
+};
@@ -1,7 +1,11 @@
 #include "cxxtest/TestSuite.h"
 #include "FrequencyCollector.hpp"
+#include "NgramTable.hpp"
 #include "PfHelpers.hpp"
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <sstream>
 
 using std::vector;
 using std::string;
@@ -30,4 +34,178 @@ public:
 			TS_ASSERT(!fc2.validNgramFile(fileNameFail));
 		}
 	}
-};
\ No newline at end of file
+
+	void testReadCount(void) {
+		const char *fileName = "test/frequencies/read.tmp";
+		{
+			std::ofstream out(fileName);
+			out << "/ comment\n\nTH 5000000000\n  HE\t7\r\nTH 3\nIN 2";
+		}
+		FrequencyCollector fc(2);
+		fc.readNgramCount(fileName);
+		TS_ASSERT_EQUALS(fc.getCounts().size(), 3u);
+		TS_ASSERT_EQUALS(fc.getCounts().at("TH"), 5000000003ull);
+		TS_ASSERT_EQUALS(fc.getCounts().at("HE"), 7u);
+		TS_ASSERT_EQUALS(fc.getCounts().at("IN"), 2u);
+		TS_ASSERT_EQUALS(fc.getCount(), 5000000012ull);
+
+		FrequencyCollector fc3(3);
+		TS_ASSERT_THROWS(fc3.readNgramCount(fileName), Exception);
+		{
+			std::ofstream out(fileName);
+			out << "TH\n";
+		}
+		TS_ASSERT_THROWS(fc.readNgramCount(fileName), Exception);
+		std::remove(fileName);
+		TS_ASSERT_THROWS(fc.readNgramCount(fileName), std::ios_base::failure);
+	}
+
+	void testCollect(void) {
+		std::stringstream ss("The 5 c@ts \n ate that l!ver.");
+		FrequencyCollector fc(2);
+		fc.collectNGrams(ss);
+		TS_ASSERT_EQUALS(fc.getCount(), 16u);
+		TS_ASSERT_EQUALS(fc.getCounts().size(), 14u);
+		TS_ASSERT_EQUALS(fc.getCounts().at("TH"), 2u);
+		TS_ASSERT_EQUALS(fc.getCounts().at("AT"), 2u);
+
+		//	Every letter is a monogram, including the first
+		std::stringstream ss1("abca");
+		FrequencyCollector fc1(1);
+		fc1.collectNGrams(ss1);
+		TS_ASSERT_EQUALS(fc1.getCount(), 4u);
+		TS_ASSERT_EQUALS(fc1.getCounts().at("A"), 2u);
+		TS_ASSERT_EQUALS(fc1.getCounts().at("B"), 1u);
+	}
+
+	void testCollectUppercase(void) {
+		string text = "ITWASTHEBESTOFTIMESITWASTHEWORSTOFTIMESZZZ";
+		//	n = 1 fills the dense table, longer n-grams and n > MAX_TABLE_N are sorted
+		std::vector<unsigned> sizes;
+		for(unsigned n = 1; n <= MAX_TABLE_N; n++) sizes.push_back(n);
+		sizes.push_back(8);
+		for(auto n = sizes.begin(); n != sizes.end(); ++n) {
+			std::stringstream ss(text);
+			FrequencyCollector streamed(*n), direct(*n);
+			streamed.collectNGrams(ss);
+			direct.collectNGrams(text.data(), text.size());
+			TS_ASSERT_EQUALS(direct.getCount(), streamed.getCount());
+			TS_ASSERT(direct.getCounts() == streamed.getCounts());
+		}
+
+		//	Long enough for a dense bigram table
+		string longText = text + text + text;
+		std::stringstream ss(longText);
+		FrequencyCollector streamed(2), direct(2);
+		streamed.collectNGrams(ss);
+		direct.collectNGrams(longText.data(), longText.size());
+		TS_ASSERT_EQUALS(direct.getCount(), streamed.getCount());
+		TS_ASSERT(direct.getCounts() == streamed.getCounts());
+
+		FrequencyCollector fc(3);
+		fc.collectNGrams("AB", 2);
+		TS_ASSERT_EQUALS(fc.getCount(), 0u);
+		TS_ASSERT_THROWS(fc.collectNGrams("The cat", 7), Exception);
+	}
+
+	void testCollectChunks(void) {
+		const char *fileName = "test/frequencies/collect.tmp";
+		{
+			std::ofstream out(fileName);
+			out << "It was the best of times, it was the worst of times;\n"
+				"it was the age of wisdom, it was the age of foolishness...";
+		}
+		for(unsigned n = 1; n <= 4; n++) {
+			FrequencyCollector whole(n);
+			whole.collectNGramsFile(fileName);
+			for(std::size_t chunk = 1; chunk <= 9; chunk++) {
+				FrequencyCollector chunked(n);
+				chunked.collectNGramsFile(fileName, chunk);
+				TS_ASSERT_EQUALS(chunked.getCount(), whole.getCount());
+				TS_ASSERT(chunked.getCounts() == whole.getCounts());
+			}
+		}
+		FrequencyCollector fc(2);
+		TS_ASSERT_THROWS(fc.collectNGramsFile(fileName, 0), InvalidParameters);
+		std::remove(fileName);
+	}
+
+	void testCollectThreads(void) {
+		const char *fileNames[] = {"test/frequencies/collect1.tmp", "test/frequencies/collect2.tmp"};
+		{
+			std::ofstream out1(fileNames[0]);
+			out1 << "It was the best of times, it was the worst of times;\n"
+				"it was the age of wisdom, it was the age of foolishness...";
+			std::ofstream out2(fileNames[1]);
+			out2 << "A b\nc, d!";
+		}
+		std::vector<const char*> files(fileNames, fileNames + 2);
+		for(unsigned n = 1; n <= 3; n++) {
+			FrequencyCollector serial(n);
+			serial.collectNGramsFile(fileNames[0]);
+			serial.collectNGramsFile(fileNames[1]);
+			std::stringstream expected;
+			serial.printNGrams(expected);
+			for(unsigned threads = 1; threads <= 13; threads += 3) {
+				FrequencyCollector parallel(n);
+				parallel.collectNGramsFiles(files, threads);
+				TS_ASSERT_EQUALS(parallel.getCount(), serial.getCount());
+				std::stringstream printed;
+				parallel.printNGrams(printed);
+				TS_ASSERT_EQUALS(printed.str(), expected.str());
+			}
+		}
+		std::remove(fileNames[0]);
+		std::remove(fileNames[1]);
+	}
+
+	void testMerge(void) {
+		FrequencyCollector first(2), second(2), both(2);
+		std::stringstream ss1("It was the best of times"), ss2("it was the worst of times");
+		std::stringstream ssBoth("It was the best of times it was the worst of times");
+		first.collectNGrams(ss1);
+		second.collectNGrams(ss2);
+		both.collectNGrams(ssBoth);
+		first += second;
+		//	Only the n-gram spanning the two texts is missing
+		TS_ASSERT_EQUALS(first.getCount() + 1, both.getCount());
+		TS_ASSERT_EQUALS(first.getCounts().at("TH"), both.getCounts().at("TH"));
+		TS_ASSERT_EQUALS(first.getCounts().count("SI"), 0u);
+
+		FrequencyCollector copy = second;
+		copy += copy;
+		TS_ASSERT_EQUALS(copy.getCount(), 2 * second.getCount());
+		TS_ASSERT_EQUALS(copy.getCounts().at("WO"), 2 * second.getCounts().at("WO"));
+
+		const char *tableFile = "test/frequencies/merge.bin";
+		second.writeNgramTable(tableFile);
+		FrequencyCollector fromTable(2);
+		fromTable += NgramTable(tableFile);
+		TS_ASSERT(fromTable.getCounts() == second.getCounts());
+		TS_ASSERT_EQUALS(fromTable.getCount(), second.getCount());
+		std::remove(tableFile);
+
+		FrequencyCollector other(3);
+		TS_ASSERT_THROWS(other += second, Exception);
+	}
+
+	void testValidReportsAll(void) {
+		const char *fileName = "test/frequencies/valid.tmp";
+		{
+			std::ofstream out(fileName);
+			out << "/ comment\nTH 10\n\nH3 4\nHE 7\nTH 2\nIN  2\nER 1";
+		}
+		std::stringstream errors;
+		std::streambuf *old = std::cerr.rdbuf(errors.rdbuf());
+		FrequencyCollector fc(2);
+		bool valid = fc.validNgramFile(fileName);
+		std::cerr.rdbuf(old);
+		std::remove(fileName);
+
+		TS_ASSERT(!valid);
+		string expected = string("Line 4 of ") + fileName + " is of wrong format\n" +
+			"Line 6 of " + fileName + " has duplicate: TH\n" +
+			"Line 7 of " + fileName + " is of wrong format\n";
+		TS_ASSERT_EQUALS(errors.str(), expected);
+	}
+};
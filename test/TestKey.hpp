@@ -1,5 +1,6 @@
 #include "cxxtest/TestSuite.h"
 #include "Key.hpp"
+#include <algorithm>
 
 using std::vector;
 using std::string;
@@ -108,4 +109,70 @@ public:
 		TS_ASSERT(correct == text);
 	}
 
+	void testBuffers(void) {
+		vector<string> plainTexts = {"THEDOGJUMPEDOVERTHEMOON", "QQZZZ", "X", ""};
+		text_t cipher, plain;
+		Key k(key);
+		for(unsigned i = 0; i < plainTexts.size(); i++) {
+			text_t pText(plainTexts.at(i).begin(), plainTexts.at(i).end());
+			k.sanitizeText(pText);
+			TS_ASSERT(k.encrypt(pText, cipher) == k.encrypt(pText));
+			TS_ASSERT(k.decrypt(cipher, plain) == k.decrypt(cipher));
+			//	Odd length cipherText is padded with the extra letter
+			TS_ASSERT(k.decrypt(pText, plain) == k.decrypt(pText));
+		}
+	}
+
+	void testDigramTable(void) {
+		string s = "THEDOGIUMPEDOVERTHEMOONQZXKA";
+		text_t cipher(s.begin(), s.end());
+		vector<string> keywords = {"", "apple", "ZYXWVUTSRQPONMLKIHGFEDCBA"};
+		for(unsigned i = 0; i < keywords.size(); i++) {
+			Key k(keywords.at(i));
+			text_t direct = k.decrypt(cipher);
+			TS_ASSERT(!k.hasDigramTable());
+			k.buildDigramTable();
+			TS_ASSERT(k.hasDigramTable());
+			TS_ASSERT(k.decrypt(cipher) == direct);
+			//	Every digram of the square
+			for(char a = 'A'; a <= 'Z'; a++) {
+				for(char b = 'A'; b <= 'Z'; b++) {
+					if(a == 'J' || b == 'J') continue;
+					text_t digram = {a, b};
+					Key noTable(keywords.at(i));
+					TS_ASSERT(k.decrypt(digram) == noTable.decrypt(digram));
+				}
+			}
+		}
+	}
+
+	void testDecryptSwap(void) {
+		string s = "UGPGNHOQKLPGIZPTUGLNMZIOABCDEFGHIKLMNOPQRSTUVWXYZ";
+		text_t cipher(s.begin(), s.end());
+		string letters = "ABCDEFGHIKLMNOPQRSTUVWXYZ";
+		Key k(key);
+		text_t plain = k.decrypt(cipher);
+		vector<std::size_t> changed;
+		for(unsigned i = 0; i < letters.size(); i++) {
+			char a = letters.at(i);
+			char b = letters.at((i * 7 + 3) % letters.size());
+			if(a == b) continue;
+			text_t before = plain;
+			k.decryptSwap(cipher, plain, a, b, changed);
+
+			Key swapped(k.getSquare());
+			TS_ASSERT(plain == swapped.decrypt(cipher));
+			for(std::size_t index = 0; index < plain.size(); index += 2) {
+				bool differs = plain[index] != before[index] || plain[index+1] != before[index+1];
+				bool listed = std::find(changed.begin(), changed.end(), index) != changed.end();
+				TS_ASSERT_EQUALS(differs, listed);
+			}
+		}
+		Key k2(key);
+		k2.swapLetters('A', 'P');
+		TS_ASSERT_EQUALS(k2.getSquare().substr(0, 4), "PALE");
+		k2.swapLetters('A', 'P');
+		TS_ASSERT_EQUALS(k2.getSquare(), "APLEBCDFGHIKMNOQRSTUVWXYZ");
+	}
+
 };
\ No newline at end of file
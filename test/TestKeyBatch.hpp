@@ -0,0 +1,50 @@
+#include "cxxtest/TestSuite.h"
+#include "Key.hpp"
+#include "KeyBatch.hpp"
+#include <algorithm>
+#include <random>
+
+using std::vector;
+using std::string;
+
+class TestKeyBatch : public CxxTest::TestSuite {
+public:
+	void testMatchesKey(void) {
+		std::mt19937 rng(7);
+		string alphabet = "ABCDEFGHIKLMNOPQRSTUVWXYZ";
+		//	More keys than one block, and keywords as well as full squares
+		vector<string> keys = {"apple", "PLAYFAIR EXAMPLE", ""};
+		for(unsigned i = 0; i < 3 * KEY_BATCH_BLOCK / 2; i++) {
+			std::shuffle(alphabet.begin(), alphabet.end(), rng);
+			keys.push_back(alphabet);
+		}
+		KeyBatch batch(keys);
+		TS_ASSERT_EQUALS(batch.size(), keys.size());
+
+		std::uniform_int_distribution<int> letter(0, 24);
+		vector<vector<char>> plainTexts;
+		//	Odd lengths get the extra letter added, like Key::decrypt()
+		for(unsigned length : {0, 1, 2, 7, 100, 301}) {
+			vector<char> cipherText(length);
+			for(unsigned i = 0; i < length; i++) {
+				cipherText[i] = alphabet[letter(rng)];
+			}
+			batch.decrypt(cipherText, plainTexts);
+			TS_ASSERT_EQUALS(plainTexts.size(), keys.size());
+			for(unsigned k = 0; k < keys.size(); k++) {
+				TS_ASSERT(plainTexts[k] == Key(keys[k]).decrypt(cipherText));
+			}
+		}
+	}
+
+	void testExtraFill(void) {
+		vector<string> keys = {"apple", "fill"};
+		KeyBatch batch(keys, 'Z');
+		vector<char> cipherText = {'A', 'P', 'L'};
+		vector<vector<char>> plainTexts;
+		batch.decrypt(cipherText, plainTexts);
+		for(unsigned k = 0; k < keys.size(); k++) {
+			TS_ASSERT(plainTexts[k] == Key(keys[k], LFILL, 'Z').decrypt(cipherText));
+		}
+	}
+};
@@ -0,0 +1,82 @@
+#include "cxxtest/TestSuite.h"
+#include "LogFitness.hpp"
+#include "FrequencyCollector.hpp"
+#include "PfHelpers.hpp"
+#include <cmath>
+
+using std::vector;
+using std::string;
+
+class TestLogFitness : public CxxTest::TestSuite {
+public:
+	void testScore(void) {
+		FrequencyCollector standardFreq(2);
+		standardFreq.readNgramCount("test/frequencies/freq_pass_2_1");
+		LogFitness fit(standardFreq);
+		TS_ASSERT_EQUALS(fit.getN(), 2u);
+		TS_ASSERT_DELTA(fit.getFloor(), std::log10(0.01 / standardFreq.getCount()), 1e-12);
+
+		string s = "THEQUICKBROWNFOX";
+		vector<char> text(s.begin(), s.end());
+		score_t expected = 0;
+		for(unsigned i = 0; i + 1 < s.size(); i++) {
+			double freq = standardFreq.frequency(s.substr(i, 2));
+			expected += freq > 0 ? std::log10(freq) : fit.getFloor();
+		}
+		TS_ASSERT_DELTA(fit.score(text), expected, 1e-9);
+
+		//	Too short for a single n-gram
+		TS_ASSERT_THROWS(fit.score(vector<char>{'T'}), Exception);
+		TS_ASSERT_THROWS(fit.rescore(vector<char>{'T'}, 0, vector<char>{'T'}, {}), Exception);
+	}
+
+	void testEnglishScoresHigher(void) {
+		FrequencyCollector standardFreq(3);
+		standardFreq.readNgramCount("frequencies/english_trigrams.txt");
+		LogFitness fit(standardFreq);
+		string english = "ITWASTHEBESTOFTIMESITWASTHEWORSTOFTIMES";
+		string shuffled = "TSMETWISTHOWESFIATRSTEOSIOTBTFESAMITWEH";
+		TS_ASSERT_LESS_THAN(fit.score(vector<char>(shuffled.begin(), shuffled.end())),
+			fit.score(vector<char>(english.begin(), english.end())));
+	}
+
+	void testEmpty(void) {
+		FrequencyCollector empty(2);
+		TS_ASSERT_THROWS(LogFitness fit(empty), Exception);
+	}
+	void testRescore(void) {
+		FrequencyCollector standardFreq(3);
+		standardFreq.readNgramCount("frequencies/english_trigrams.txt");
+		LogFitness fit(standardFreq);
+		string s = "ITWASTHEBESTOFTIMESITWASTHEWORSTOFTIMES";
+		vector<char> oldText(s.begin(), s.end());
+		vector<vector<std::size_t>> changes = {{}, {0}, {2, 4}, {10, 20, 36}, {38}};
+		for(unsigned i = 0; i < changes.size(); i++) {
+			vector<char> newText = oldText;
+			for(std::size_t index : changes.at(i)) {
+				newText[index] = 'Q';
+				if(index + 1 < newText.size()) newText[index + 1] = 'Z';
+			}
+			TS_ASSERT_DELTA(fit.rescore(oldText, fit.score(oldText), newText, changes.at(i)),
+				fit.score(newText), 1e-9);
+		}
+	}
+
+	void testEveryN(void) {
+		char fileName[] = "test/frequencies/freq_pass_1_1";
+		string s = "THEQUICKBROWNFOXJUMPSOVERTHELAZYDOG";
+		vector<char> text(s.begin(), s.end());
+		for(unsigned n = 1; n <= 5; n++) {
+			fileName[27] = '0' + n;
+			FrequencyCollector standardFreq(n);
+			standardFreq.readNgramCount(fileName);
+			LogFitness fit(standardFreq);
+			score_t expected = 0;
+			for(unsigned i = 0; i + n <= s.size(); i++) {
+				double freq = standardFreq.frequency(s.substr(i, n));
+				expected += freq > 0 ? std::log10(freq) : fit.getFloor();
+			}
+			TS_ASSERT_DELTA(fit.score(text), expected, 1e-9);
+		}
+	}
+};
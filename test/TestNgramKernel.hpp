@@ -0,0 +1,54 @@
+#include "cxxtest/TestSuite.h"
+#include "NgramKernel.hpp"
+#include "FrequencyCollector.hpp"
+#include "PfHelpers.hpp"
+#include <random>
+
+using std::vector;
+using std::string;
+
+class TestNgramKernel : public CxxTest::TestSuite {
+public:
+	void testIndices(void) {
+		string s = "THEQUICKBROWNFOXJUMPSOVERTHELAZYDOGZZZZZ";
+		for(unsigned n = 1; n <= 5; n++) {
+			std::size_t windows = s.size() - n + 1;
+			vector<unsigned long> indices(windows);
+			NgramKernel::indexKernel(n)(s.data(), windows, indices.data());
+			for(std::size_t pos = 0; pos < windows; pos++) {
+				TS_ASSERT_EQUALS(indices[pos], FrequencyCollector::ngramIndex(s.data() + pos, n));
+			}
+		}
+		TS_ASSERT(NgramKernel::indexKernel(6) == nullptr);
+		TS_ASSERT(NgramKernel::sumKernel(6) == nullptr);
+	}
+
+	void testSimdMatchesScalar(void) {
+		std::mt19937 rng(3);
+		std::uniform_int_distribution<int> letter(0, 25);
+		std::uniform_real_distribution<double> value(-8, 0);
+		for(unsigned n = 1; n <= 5; n++) {
+			vector<score_t> table(FrequencyCollector::tableSize(n));
+			for(auto it = table.begin(); it != table.end(); ++it) {
+				*it = value(rng);
+			}
+			NgramKernel::SumKernel scalar = NgramKernel::sumKernel(n, false);
+			NgramKernel::SumKernel simd = NgramKernel::sumKernel(n);
+			for(std::size_t length = n; length < 60; length++) {
+				vector<char> text(length);
+				for(auto it = text.begin(); it != text.end(); ++it) {
+					*it = 'A' + letter(rng);
+				}
+				std::size_t windows = length - n + 1;
+				score_t expected = 0;
+				for(std::size_t pos = 0; pos < windows; pos++) {
+					expected += table[FrequencyCollector::ngramIndex(text.data() + pos, n)];
+				}
+				score_t sum = scalar(table.data(), text.data(), windows);
+				TS_ASSERT_DELTA(sum, expected, 1e-9);
+				//	Same order of additions, so exactly the same result
+				TS_ASSERT_EQUALS(simd(table.data(), text.data(), windows), sum);
+			}
+		}
+	}
+};
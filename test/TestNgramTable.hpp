@@ -0,0 +1,74 @@
+#include "cxxtest/TestSuite.h"
+#include "NgramTable.hpp"
+#include "FrequencyCollector.hpp"
+#include "EnglishFitness.hpp"
+#include "LogFitness.hpp"
+#include "PfHelpers.hpp"
+#include <cstdio>
+#include <fstream>
+
+using std::vector;
+using std::string;
+
+class TestNgramTable : public CxxTest::TestSuite {
+public:
+	const char *tableFile = "test/frequencies/table.bin";
+
+	void tearDown(void) {
+		std::remove(tableFile);
+	}
+
+	void testRoundTrip(void) {
+		FrequencyCollector standardFreq(2);
+		standardFreq.readNgramCount("test/frequencies/freq_pass_2_1");
+		standardFreq.writeNgramTable(tableFile);
+		TS_ASSERT(NgramTable::isTableFile(tableFile));
+		TS_ASSERT(!NgramTable::isTableFile("test/frequencies/freq_pass_2_1"));
+
+		NgramTable table(tableFile);
+		TS_ASSERT_EQUALS(table.getN(), 2u);
+		TS_ASSERT_EQUALS(table.size(), 676ul);
+		TS_ASSERT_EQUALS(table.getCount(), standardFreq.getCount());
+		TS_ASSERT(table.frequencyTable() == standardFreq.frequencyTable());
+		TS_ASSERT_EQUALS(table.getCounts()[FrequencyCollector::ngramIndex("TH", 2)],
+			standardFreq.getCounts().at("TH"));
+
+		FrequencyCollector readBack(2);
+		readBack.readNgramTable(tableFile);
+		TS_ASSERT_EQUALS(readBack.getCount(), standardFreq.getCount());
+		TS_ASSERT(readBack.getCounts() == standardFreq.getCounts());
+
+		FrequencyCollector wrongN(3);
+		TS_ASSERT_THROWS(wrongN.readNgramTable(tableFile), Exception);
+	}
+
+	void testFitness(void) {
+		FrequencyCollector standardFreq(2);
+		standardFreq.readNgramCount("frequencies/english_bigrams.txt");
+		standardFreq.writeNgramTable(tableFile);
+		NgramTable table(tableFile);
+
+		string s = "ITWASTHEBESTOFTIMESITWASTHEWORSTOFTIMES";
+		vector<char> text(s.begin(), s.end());
+		TS_ASSERT_EQUALS(LogFitness(table).score(text), LogFitness(standardFreq).score(text));
+		TS_ASSERT_EQUALS(EnglishFitness(table).score(text), EnglishFitness(standardFreq).score(text));
+	}
+
+	void testInvalid(void) {
+		TS_ASSERT_THROWS(NgramTable("test/frequencies/freq_pass_2_1"), Exception);
+		TS_ASSERT_THROWS(NgramTable("test/frequencies/missing"), std::ios_base::failure);
+
+		//	Header only, counts are missing
+		FrequencyCollector standardFreq(2);
+		standardFreq.readNgramCount("test/frequencies/freq_pass_2_1");
+		standardFreq.writeNgramTable(tableFile);
+		std::ifstream in(tableFile, std::ifstream::binary);
+		vector<char> header(sizeof(NgramTableHeader));
+		in.read(header.data(), header.size());
+		in.close();
+		std::ofstream out(tableFile, std::ofstream::binary);
+		out.write(header.data(), header.size());
+		out.close();
+		TS_ASSERT_THROWS(NgramTable(tableFile).getN(), Exception);
+	}
+};
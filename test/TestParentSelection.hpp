@@ -0,0 +1,87 @@
+#include "cxxtest/TestSuite.h"
+#include "ParentSelection.hpp"
+#include "PfHelpers.hpp"
+
+using std::vector;
+
+class TestParentSelection : public CxxTest::TestSuite {
+public:
+	//	Shares above the worst score are 0, 1, 2, 3 and 4
+	vector<score_t> scores = {-7, -3, -5, -6, -4};
+
+	void testRoulette(void) {
+		ParentSelection::RouletteWheel wheel(scores);
+		rng_t rng(1);
+		vector<unsigned> counts(scores.size());
+		for(unsigned i = 0; i < 10000; i++) {
+			++counts[wheel.spin(rng)];
+			TS_ASSERT_DIFFERS(wheel.spin(rng, 1), 1);
+		}
+		TS_ASSERT_EQUALS(counts[0], 0);
+		TS_ASSERT_DELTA(counts[1] / 10000.0, 0.4, 0.02);
+		TS_ASSERT_DELTA(counts[3] / 10000.0, 0.1, 0.02);
+
+		TS_ASSERT_THROWS(ParentSelection::RouletteWheel(vector<score_t>(1)), InvalidParameters);
+	}
+
+	void testEqualScores(void) {
+		ParentSelection::RouletteWheel wheel(vector<score_t>(3, -2));
+		rng_t rng(2);
+		vector<unsigned> counts(3);
+		for(unsigned i = 0; i < 3000; i++) {
+			++counts[wheel.spin(rng, 0)];
+		}
+		TS_ASSERT_EQUALS(counts[0], 0);
+		TS_ASSERT_LESS_THAN(1000, counts[1]);
+		TS_ASSERT_LESS_THAN(1000, counts[2]);
+	}
+
+	void testSample(void) {
+		ParentSelection::RouletteWheel wheel(scores);
+		rng_t rng(3);
+		vector<unsigned> picked;
+		//	Every member is picked its expected number of times, rounded either way
+		wheel.sample(20, rng, picked);
+		TS_ASSERT_EQUALS(picked.size(), 20);
+		TS_ASSERT(std::is_sorted(picked.begin(), picked.end()));
+		vector<unsigned> counts(scores.size());
+		for(auto it = picked.begin(); it != picked.end(); ++it) {
+			++counts[*it];
+		}
+		TS_ASSERT(counts == vector<unsigned>({0, 8, 4, 2, 6}));
+	}
+
+	void testTournament(void) {
+		rng_t rng(4);
+		for(unsigned i = 0; i < 100; i++) {
+			TS_ASSERT_DIFFERS(ParentSelection::tournament(scores, 3, rng, 1), 1);
+		}
+		//	A large enough tournament nearly always holds the best member
+		TS_ASSERT_EQUALS(ParentSelection::tournament(scores, 200, rng), 1);
+		TS_ASSERT_EQUALS(ParentSelection::tournament(scores, 200, rng, 1), 4);
+	}
+
+	void testSelectParents(void) {
+		rng_t rng(5);
+		vector<parents_t> pairs;
+		for(unsigned selection = ROULETTE; selection <= TOURNAMENT; selection++) {
+			GenParams params { 10, 0, SWAP, 0, 0, selection, 3, 50 };
+			ParentSelection::selectParents(scores, params, rng, pairs);
+			TS_ASSERT_EQUALS(pairs.size(), 50);
+			for(auto it = pairs.begin(); it != pairs.end(); ++it) {
+				TS_ASSERT_DIFFERS(it->first, it->second);
+				TS_ASSERT_LESS_THAN(it->first, scores.size());
+				TS_ASSERT_LESS_THAN(it->second, scores.size());
+			}
+		}
+		//	Unset fields select a single pair
+		GenParams params { 10, 0, SWAP, 0, 0 };
+		TS_ASSERT_EQUALS(ParentSelection::selectParents(scores, params, rng, pairs).size(), 1);
+
+		params.selection = TOURNAMENT + 1;
+		TS_ASSERT_THROWS(ParentSelection::selectParents(scores, params, rng, pairs), InvalidParameters);
+		params.selection = TOURNAMENT;
+		TS_ASSERT_THROWS(ParentSelection::selectParents(vector<score_t>(1), params, rng, pairs),
+			InvalidParameters);
+	}
+};
@@ -0,0 +1,164 @@
+#include "cxxtest/TestSuite.h"
+#include "PlayfairGenetic.hpp"
+#include "LogFitness.hpp"
+#include "FrequencyCollector.hpp"
+#include "PfHelpers.hpp"
+#include <set>
+
+using std::vector;
+using std::string;
+
+class TestPlayfairGenetic : public CxxTest::TestSuite {
+public:
+	string cipher = "BPVYKZDMDIKZSAPBIXKMUZFOZBXVNEKZSAPBIXKMUZFOZBDEDXSATXOHSEBPVYKZDM";
+	GenParams params { 14, 2, SWAP, 4, 1 };
+
+	void testThreadsDeterministic(void) {
+		FrequencyCollector standardFreq(2);
+		standardFreq.readNgramCount("frequencies/english_bigrams.txt");
+		LogFitness fit(standardFreq);
+		vector<char> cipherText(cipher.begin(), cipher.end());
+
+		vector<pop_t> populations;
+		for(unsigned threads = 1; threads <= 4; threads++) {
+			rng_t rng(42);
+			pop_t population;
+			PlayfairGenetic::initializePopulationRandom(18, population, rng);
+			for(unsigned generation = 0; generation < 10; generation++) {
+				PlayfairGenetic::nextGeneration(fit, cipherText, params, population, rng, threads);
+			}
+			TS_ASSERT(PlayfairGenetic::fitScores(fit, population, cipherText, threads) ==
+				PlayfairGenetic::fitScores(fit, population, cipherText));
+			populations.push_back(population);
+		}
+		for(unsigned i = 1; i < populations.size(); i++) {
+			TS_ASSERT(populations.at(i) == populations.at(0));
+		}
+	}
+
+	void testReuseScores(void) {
+		FrequencyCollector standardFreq(2);
+		standardFreq.readNgramCount("frequencies/english_bigrams.txt");
+		LogFitness fit(standardFreq);
+		vector<char> cipherText(cipher.begin(), cipher.end());
+
+		//	Passing the scores along gives the same populations as scoring each time
+		rng_t rng(42), rngScored(42);
+		pop_t population, scoredPopulation;
+		PlayfairGenetic::initializePopulationRandom(18, population, rng);
+		PlayfairGenetic::initializePopulationRandom(18, scoredPopulation, rngScored);
+		vector<score_t> scores;
+		for(unsigned generation = 0; generation < 10; generation++) {
+			PlayfairGenetic::nextGeneration(fit, cipherText, params, population, rng);
+			PlayfairGenetic::nextGeneration(fit, cipherText, params, scoredPopulation,
+				rngScored, 2, &scores);
+			TS_ASSERT(scoredPopulation == population);
+			TS_ASSERT(scores == PlayfairGenetic::fitScores(fit, population, cipherText));
+		}
+
+		scores.pop_back();
+		TS_ASSERT_THROWS(PlayfairGenetic::nextGeneration(fit, cipherText, params, scoredPopulation,
+			rngScored, 1, &scores), InvalidParameters);
+	}
+
+	//	Number of members that are rotations of another member
+	unsigned duplicates(const pop_t &population) {
+		std::set<string> squares;
+		for(auto it = population.begin(); it != population.end(); ++it) {
+			squares.insert(Key::canonicalKey(*it));
+		}
+		return population.size() - squares.size();
+	}
+
+	void testUniqueMembers(void) {
+		FrequencyCollector standardFreq(2);
+		standardFreq.readNgramCount("frequencies/english_bigrams.txt");
+		LogFitness fit(standardFreq);
+		vector<char> cipherText(cipher.begin(), cipher.end());
+
+		rng_t rng(8);
+		pop_t population;
+		//	24 squares start with this seed
+		PlayfairGenetic::initializePopulationSeed(20, population, rng, "ABCDEFGHIKLMNOPQRSTUV");
+		TS_ASSERT_EQUALS(population.size(), 20);
+		TS_ASSERT_EQUALS(duplicates(population), 0);
+		//	Only one square does, so the population is filled with it
+		PlayfairGenetic::initializePopulationSeed(4, population, rng, "ABCDEFGHIKLMNOPQRSTUVWXY");
+		TS_ASSERT_EQUALS(population.size(), 4);
+		TS_ASSERT_EQUALS(duplicates(population), 3);
+
+		PlayfairGenetic::initializePopulationRandom(18, population, rng);
+		TS_ASSERT_EQUALS(duplicates(population), 0);
+		for(unsigned generation = 0; generation < 50; generation++) {
+			PlayfairGenetic::nextGeneration(fit, cipherText, params, population, rng);
+			TS_ASSERT_EQUALS(duplicates(population), 0);
+		}
+
+		//	Migrants are not added to an island that holds them already, and
+		//	equivalent kept members are not both kept
+		GenParams islandParams { 12, 4, SWAP, 0, 4 };
+		vector<pop_t> islands(3);
+		vector<vector<score_t>> scores(islands.size());
+		for(unsigned island = 0; island < islands.size(); island++) {
+			PlayfairGenetic::initializePopulationRandom(18, islands[island], rng);
+		}
+		for(unsigned generation = 1; generation <= 200; generation++) {
+			for(unsigned island = 0; island < islands.size(); island++) {
+				PlayfairGenetic::nextGeneration(fit, cipherText, islandParams, islands[island],
+					rng, 1, &scores[island]);
+			}
+			if(generation % 10 == 0)
+				PlayfairGenetic::migrate(islands, scores);
+			for(unsigned island = 0; island < islands.size(); island++) {
+				TS_ASSERT_EQUALS(duplicates(islands[island]), 0);
+			}
+		}
+	}
+
+	void testParentPairs(void) {
+		FrequencyCollector standardFreq(2);
+		standardFreq.readNgramCount("frequencies/english_bigrams.txt");
+		LogFitness fit(standardFreq);
+		vector<char> cipherText(cipher.begin(), cipher.end());
+
+		//	A member in several pairs carries on once, so the population never holds
+		//	more than every pair being distinct
+		GenParams pairParams { 6, 2, SWAP, 2, 1, TOURNAMENT, 3, 8 };
+		rng_t rng(11);
+		pop_t population;
+		PlayfairGenetic::initializePopulationRandom(25, population, rng);
+		for(unsigned generation = 0; generation < 30; generation++) {
+			PlayfairGenetic::nextGeneration(fit, cipherText, pairParams, population, rng);
+			TS_ASSERT(population.size() <= 2 * 8 + 6 + 2 + 1);
+			TS_ASSERT(population.size() >= 2 + 6 + 2 + 1);
+			TS_ASSERT_EQUALS(duplicates(population), 0);
+		}
+
+		//	One pair always keeps both parents
+		for(unsigned generation = 0; generation < 10; generation++) {
+			PlayfairGenetic::nextGeneration(fit, cipherText, params, population, rng);
+			TS_ASSERT_EQUALS(population.size(), 2 + 14 + 2 + 1);
+		}
+	}
+
+	void testMigrate(void) {
+		vector<pop_t> islands { {"A", "B", "C"}, {"D", "E"}, {"F", "G"} };
+		vector<vector<score_t>> scores { {1, 3, 2}, {-1, -2}, {5, 4} };
+		PlayfairGenetic::migrate(islands, scores);
+		TS_ASSERT(islands.at(0) == pop_t({"F", "B", "C"}));
+		TS_ASSERT(islands.at(1) == pop_t({"D", "B"}));
+		TS_ASSERT(islands.at(2) == pop_t({"F", "D"}));
+		TS_ASSERT(scores.at(0) == vector<score_t>({5, 3, 2}));
+		TS_ASSERT(scores.at(2) == vector<score_t>({5, -1}));
+
+		//	The second island already holds a rotation of the first one's best key
+		islands = { {"PLAYFIREXMBCDGHKNOQSTUVWZ", "B"}, {"AYFPLEXMIRDGHBCOQSKNVWZTU", "C"} };
+		scores = { {2, 1}, {-2, -1} };
+		PlayfairGenetic::migrate(islands, scores);
+		TS_ASSERT(islands.at(1) == pop_t({"AYFPLEXMIRDGHBCOQSKNVWZTU", "C"}));
+		TS_ASSERT(islands.at(0) == pop_t({"PLAYFIREXMBCDGHKNOQSTUVWZ", "C"}));
+
+		scores.pop_back();
+		TS_ASSERT_THROWS(PlayfairGenetic::migrate(islands, scores), InvalidParameters);
+	}
+};
@@ -0,0 +1,104 @@
+#include "cxxtest/TestSuite.h"
+#include "ScoreCache.hpp"
+#include "Key.hpp"
+#include "PlayfairGenetic.hpp"
+#include "LogFitness.hpp"
+#include "FrequencyCollector.hpp"
+#include <stdexcept>
+#include <thread>
+
+using std::vector;
+using std::string;
+
+class TestScoreCache : public CxxTest::TestSuite {
+public:
+	string square = "PLAYFIREXMBCDGHKNOQSTUVWZ";
+
+	//	Shifts the rows down and the columns right of square
+	string rotate(const string &key, int rows, int columns) {
+		string rotated(25, ' ');
+		for(int place = 0; place < 25; place++) {
+			rotated[5 * ((place / 5 + rows) % 5) + (place % 5 + columns) % 5] = key[place];
+		}
+		return rotated;
+	}
+
+	void testCanonicalSquare(void) {
+		string canonical = Key::canonicalSquare(square);
+		TS_ASSERT_EQUALS(canonical, "AYFPLEXMIRDGHBCOQSKNVWZTU");
+		vector<char> cipherText = {'T', 'H', 'E', 'Q', 'U', 'I', 'C', 'K', 'B', 'R', 'O', 'W'};
+		for(int rows = 0; rows < 5; rows++) {
+			for(int columns = 0; columns < 5; columns++) {
+				string rotated = rotate(square, rows, columns);
+				TS_ASSERT_EQUALS(Key::canonicalSquare(rotated), canonical);
+				TS_ASSERT(Key(rotated).decrypt(cipherText) == Key(square).decrypt(cipherText));
+			}
+		}
+		TS_ASSERT_THROWS(Key::canonicalSquare("ABC"), std::invalid_argument);
+		TS_ASSERT_EQUALS(Key::canonicalKey("playfair example"), canonical);
+		TS_ASSERT_EQUALS(Key::canonicalKey(square), canonical);
+		//	25 letters, but not a square
+		string keyword = "PLAYFAIREXAMPLEPLAYFAIREX";
+		TS_ASSERT_EQUALS(Key::canonicalKey(keyword), Key::canonicalSquare(Key(keyword).getSquare()));
+	}
+
+	void testFindInsert(void) {
+		ScoreCache cache(100);
+		score_t score = 0;
+		TS_ASSERT(!cache.find(Key::canonicalKey(square), score));
+		cache.insert(Key::canonicalKey(square), -12.5);
+		TS_ASSERT(cache.find(Key::canonicalKey(rotate(square, 2, 3)), score));
+		TS_ASSERT_EQUALS(score, -12.5);
+		TS_ASSERT_EQUALS(cache.hits(), 1);
+		TS_ASSERT_EQUALS(cache.misses(), 1);
+		TS_ASSERT_EQUALS(cache.size(), 1);
+		cache.clear();
+		TS_ASSERT_EQUALS(cache.size(), 0);
+		TS_ASSERT(!cache.find(Key::canonicalKey(square), score));
+	}
+
+	void testBounded(void) {
+		ScoreCache cache(SCORE_CACHE_SHARDS);
+		rng_t rng(1);
+		pop_t population;
+		PlayfairGenetic::initializePopulationRandom(500, population, rng);
+		//	Many threads at once never hold more than the capacity
+		vector<std::thread> workers;
+		for(unsigned t = 0; t < 4; t++) {
+			workers.emplace_back([&, t]() {
+				for(unsigned index = t; index < population.size(); index += 4) {
+					cache.insert(Key::canonicalKey(population[index]), index);
+				}
+			});
+		}
+		for(auto it = workers.begin(); it != workers.end(); ++it) {
+			it->join();
+		}
+		TS_ASSERT(cache.size() <= SCORE_CACHE_SHARDS);
+		TS_ASSERT(cache.size() > 0);
+
+		ScoreCache off(0);
+		off.insert(Key::canonicalKey(square), 1);
+		TS_ASSERT_EQUALS(off.size(), 0);
+	}
+
+	void testFitScores(void) {
+		FrequencyCollector standardFreq(2);
+		standardFreq.readNgramCount("frequencies/english_bigrams.txt");
+		LogFitness fit(standardFreq);
+		string cipher = "BPVYKZDMDIKZSAPBIXKMUZFOZBXVNEKZSAPBIXKMUZFOZBDEDXSATXOHSEBPVYKZDM";
+		vector<char> cipherText(cipher.begin(), cipher.end());
+		rng_t rng(5);
+		pop_t population;
+		PlayfairGenetic::initializePopulationRandom(20, population, rng);
+		population.push_back(population[3]);
+		population.push_back(rotate(population[7], 1, 4));
+
+		ScoreCache cache(1000);
+		vector<score_t> scores = PlayfairGenetic::fitScores(fit, population, cipherText);
+		TS_ASSERT(PlayfairGenetic::fitScores(fit, population, cipherText, 3, &cache) == scores);
+		TS_ASSERT(PlayfairGenetic::fitScores(fit, population, cipherText, 1, &cache) == scores);
+		TS_ASSERT_EQUALS(cache.hits() + cache.misses(), 2 * population.size());
+		TS_ASSERT(cache.hits() >= population.size());
+	}
+};
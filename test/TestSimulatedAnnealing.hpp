@@ -0,0 +1,54 @@
+#include "cxxtest/TestSuite.h"
+#include "SimulatedAnnealing.hpp"
+#include "LogFitness.hpp"
+#include "FrequencyCollector.hpp"
+#include "Key.hpp"
+#include "PfHelpers.hpp"
+#include <algorithm>
+
+using std::vector;
+using std::string;
+
+class TestSimulatedAnnealing : public CxxTest::TestSuite {
+public:
+	void testShuffleKey(void) {
+		rng_t rng(7);
+		string key = "ABCDEFGHIKLMNOPQRSTUVWXYZ";
+		string sorted = key;
+		for(unsigned i = 0; i < 100; i++) {
+			SimulatedAnnealing::shuffleKey(key, rng);
+			string letters = key;
+			std::sort(letters.begin(), letters.end());
+			TS_ASSERT_EQUALS(letters, sorted);
+		}
+	}
+
+	void testAnneal(void) {
+		FrequencyCollector standardFreq(2);
+		standardFreq.readNgramCount("frequencies/english_bigrams.txt");
+		LogFitness fit(standardFreq);
+
+		string s = "ITWASTHEBESTOFTIMESITWASTHEWORSTOFTIMESITWASTHEAGEOFWISDOM";
+		vector<char> plain(s.begin(), s.end()), cipher;
+		Key key("PLAYFAIREXAMPLE");
+		key.sanitizeText(plain);
+		key.encrypt(plain, cipher);
+
+		AnnealParams params { 10, 1, 200 };
+		rng_t rng1(3), rng2(3);
+		string start = "ABCDEFGHIKLMNOPQRSTUVWXYZ";
+		auto first = SimulatedAnnealing::anneal(fit, cipher, params, start, rng1);
+		auto second = SimulatedAnnealing::anneal(fit, cipher, params, start, rng2);
+		TS_ASSERT_EQUALS(first.first, second.first);
+		TS_ASSERT_EQUALS(first.second, second.second);
+
+		//	The reported score belongs to the returned key
+		vector<char> decrypted;
+		Key(first.first).decrypt(cipher, decrypted);
+		TS_ASSERT_DELTA(fit.score(decrypted), first.second, 1e-9);
+
+		//	Never worse than the starting key
+		Key(start).decrypt(cipher, decrypted);
+		TS_ASSERT(first.second >= fit.score(decrypted) - 1e-9);
+	}
+};